@@ -0,0 +1,448 @@
+#ifndef CANDIDATE_STORE_HPP
+#define CANDIDATE_STORE_HPP
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Utilis.hpp"
+#include "Shellsort.hpp"
+#include "FitnessCache.hpp"
+#include "FilesManagement.hpp"
+
+// Binary candidate store, readable through mmap without parsing. Layout (8-byte aligned sections):
+// Header | records (RecordHeader + gapsWidth fixed gap slots) | hash index | tags | interned strings
+namespace candidate_store
+{
+    const char MAGIC[8] = { 'S', 'S', 'C', 'A', 'N', 'D', 'S', 'T' };
+    const std::uint32_t VERSION = 1;
+
+    struct StringRef
+    {
+        std::uint64_t offset;
+        std::uint64_t length;
+    };
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t gapsWidth; //gap slots per record, unused slots are 0
+        std::uint64_t recordsCount;
+        std::uint64_t recordSize;
+        std::uint64_t recordsOffset;
+        std::uint64_t indexCapacity; //power of two, slot holds record index + 1 (0 - empty)
+        std::uint64_t indexOffset;
+        std::uint64_t tagsCount;
+        std::uint64_t tagsOffset;
+        std::uint64_t stringsOffset;
+        std::uint64_t stringsBytes;
+    };
+
+    struct RecordHeader
+    {
+        std::uint64_t sortingRange;
+        std::uint64_t hash;
+        StringRef name;
+        std::uint32_t tag; //index into tags, algorithm that found the sequence
+        std::uint32_t gapsCount;
+        std::uint64_t samples; //0 - no fitness statistics
+        double operations;
+        double operationsStdDev;
+        double time;
+    };
+
+    // Stable across builds and platforms, it is stored in the file
+    template <typename Gap>
+    std::uint64_t GetKeyHash(std::uint64_t sortingRange, const Gap* gaps, std::size_t gapsCount)
+    {
+        std::uint64_t hash = utilis::SplitMix64(sortingRange);
+        for (std::size_t g = 0; g < gapsCount; g++) hash = utilis::SplitMix64(hash ^ static_cast<std::uint64_t>(gaps[g]));
+        return hash;
+    }
+
+    std::uint64_t AlignUp(std::uint64_t value) { return (value + 7) & ~std::uint64_t(7); }
+
+    class CandidateStoreBuilder
+    {
+        public:
+        // False if (sortingRange, gaps) is already in the store
+        bool Add(unsigned long sortingRange, const std::string& tag, const GapSequence& gapSequence, const CachedFitness* fitness = nullptr)
+        {
+            std::uint64_t hash = GetKeyHash(sortingRange, gapSequence.gaps.data(), gapSequence.gaps.size());
+            auto range = keys.equal_range(hash);
+            for (auto it = range.first; it != range.second; it++)
+            {
+                const Entry& other = entries[it->second];
+                if (other.sortingRange == sortingRange && other.gaps == gapSequence.gaps) return false;
+            }
+
+            Entry entry;
+            entry.sortingRange = sortingRange;
+            entry.hash = hash;
+            entry.name = Intern(gapSequence.name);
+            entry.tag = GetTagIndex(tag);
+            entry.gaps = gapSequence.gaps;
+            if (fitness != nullptr) SetFitness(entry, *fitness);
+
+            keys.emplace(hash, entries.size());
+            entries.push_back(entry);
+            return true;
+        }
+
+        std::size_t Size() const { return entries.size(); }
+
+        // Fitness statistics of every record known to the cache
+        void AddFitnessFromCache(const FitnessCache& cache)
+        {
+            for (Entry& entry : entries)
+            {
+                CachedFitness fitness;
+                if (cache.Get(entry.sortingRange, entry.gaps, fitness)) SetFitness(entry, fitness);
+            }
+        }
+
+        bool Write(const std::string& path) const
+        {
+            std::uint32_t gapsWidth = 1;
+            for (const Entry& entry : entries) gapsWidth = std::max<std::uint32_t>(gapsWidth, static_cast<std::uint32_t>(entry.gaps.size()));
+
+            std::uint64_t indexCapacity = 2;
+            while (indexCapacity < 2 * entries.size()) indexCapacity <<= 1;
+
+            std::vector<StringRef> stringRefs;
+            std::uint64_t stringsBytes = 0;
+            for (const std::string& s : strings)
+            {
+                stringRefs.push_back(StringRef{ stringsBytes, s.size() });
+                stringsBytes += s.size();
+            }
+
+            Header header{};
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.gapsWidth = gapsWidth;
+            header.recordsCount = entries.size();
+            header.recordSize = sizeof(RecordHeader) + gapsWidth * sizeof(std::uint64_t);
+            header.recordsOffset = AlignUp(sizeof(Header));
+            header.indexCapacity = indexCapacity;
+            header.indexOffset = AlignUp(header.recordsOffset + header.recordsCount * header.recordSize);
+            header.tagsCount = tags.size();
+            header.tagsOffset = AlignUp(header.indexOffset + indexCapacity * sizeof(std::uint64_t));
+            header.stringsOffset = AlignUp(header.tagsOffset + tags.size() * sizeof(StringRef));
+            header.stringsBytes = stringsBytes;
+
+            std::vector<char> buffer(header.stringsOffset + stringsBytes, 0);
+            std::memcpy(buffer.data(), &header, sizeof(header));
+
+            std::uint64_t* index = reinterpret_cast<std::uint64_t*>(buffer.data() + header.indexOffset);
+            for (std::size_t r = 0; r < entries.size(); r++)
+            {
+                const Entry& entry = entries[r];
+                char* record = buffer.data() + header.recordsOffset + r * header.recordSize;
+
+                RecordHeader recordHeader{};
+                recordHeader.sortingRange = entry.sortingRange;
+                recordHeader.hash = entry.hash;
+                recordHeader.name = stringRefs[entry.name];
+                recordHeader.tag = entry.tag;
+                recordHeader.gapsCount = static_cast<std::uint32_t>(entry.gaps.size());
+                recordHeader.samples = entry.samples;
+                recordHeader.operations = entry.operations;
+                recordHeader.operationsStdDev = entry.operationsStdDev;
+                recordHeader.time = entry.time;
+                std::memcpy(record, &recordHeader, sizeof(recordHeader));
+
+                std::uint64_t* gaps = reinterpret_cast<std::uint64_t*>(record + sizeof(RecordHeader));
+                for (std::size_t g = 0; g < entry.gaps.size(); g++) gaps[g] = entry.gaps[g];
+
+                std::uint64_t slot = entry.hash & (indexCapacity - 1);
+                while (index[slot] != 0) slot = (slot + 1) & (indexCapacity - 1);
+                index[slot] = r + 1;
+            }
+
+            for (std::size_t t = 0; t < tags.size(); t++)
+            {
+                std::memcpy(buffer.data() + header.tagsOffset + t * sizeof(StringRef), &stringRefs[tags[t]], sizeof(StringRef));
+            }
+            for (std::size_t s = 0; s < strings.size(); s++)
+            {
+                std::memcpy(buffer.data() + header.stringsOffset + stringRefs[s].offset, strings[s].data(), strings[s].size());
+            }
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                std::cerr << "ERROR: Could not open file for writing: " << path << std::endl;
+                return false;
+            }
+            file.write(buffer.data(), buffer.size());
+            return static_cast<bool>(file);
+        }
+
+        private:
+        struct Entry
+        {
+            unsigned long sortingRange = 0;
+            std::uint64_t hash = 0;
+            std::uint32_t name = 0;
+            std::uint32_t tag = 0;
+            std::vector<unsigned long> gaps;
+            std::uint64_t samples = 0;
+            double operations = 0.0;
+            double operationsStdDev = 0.0;
+            double time = 0.0;
+        };
+
+        std::vector<Entry> entries;
+        std::unordered_multimap<std::uint64_t, std::size_t> keys;
+        //Names and tags are interned, lineage names repeat a lot across files
+        std::vector<std::string> strings;
+        std::unordered_map<std::string, std::uint32_t> stringIds;
+        std::vector<std::uint32_t> tags;
+
+        std::uint32_t Intern(const std::string& s)
+        {
+            auto it = stringIds.find(s);
+            if (it != stringIds.end()) return it->second;
+            strings.push_back(s);
+            return stringIds[s] = static_cast<std::uint32_t>(strings.size() - 1);
+        }
+
+        std::uint32_t GetTagIndex(const std::string& tag)
+        {
+            std::uint32_t id = Intern(tag);
+            auto it = std::find(tags.begin(), tags.end(), id);
+            if (it != tags.end()) return static_cast<std::uint32_t>(it - tags.begin());
+            tags.push_back(id);
+            return static_cast<std::uint32_t>(tags.size() - 1);
+        }
+
+        static void SetFitness(Entry& entry, const CachedFitness& fitness)
+        {
+            entry.samples = fitness.GetSamples();
+            entry.operations = fitness.operations.mean;
+            entry.operationsStdDev = fitness.operations.GetStdDev();
+            entry.time = fitness.time.mean;
+        }
+    };
+
+    // Read-only view of a store file mapped into memory
+    class CandidateStore
+    {
+        public:
+        CandidateStore(const std::string& path)
+        {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) == 0 && static_cast<std::size_t>(fileStat.st_size) >= sizeof(Header))
+            {
+                size = static_cast<std::size_t>(fileStat.st_size);
+                void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped != MAP_FAILED) data = static_cast<const char*>(mapped);
+            }
+            close(fd);
+
+            if (data != nullptr && !IsValid())
+            {
+                std::cerr << "ERROR: Not a valid candidate store: " << path << std::endl;
+                munmap(const_cast<char*>(data), size);
+                data = nullptr;
+            }
+        }
+
+        ~CandidateStore()
+        {
+            if (data != nullptr) munmap(const_cast<char*>(data), size);
+        }
+
+        CandidateStore(const CandidateStore&) = delete;
+        CandidateStore& operator=(const CandidateStore&) = delete;
+
+        bool IsOpen() const { return data != nullptr; }
+
+        std::size_t Size() const { return IsOpen() ? GetHeader().recordsCount : 0; }
+
+        const RecordHeader& GetRecord(std::size_t r) const
+        {
+            return *reinterpret_cast<const RecordHeader*>(data + GetHeader().recordsOffset + r * GetHeader().recordSize);
+        }
+
+        const std::uint64_t* GetGaps(std::size_t r) const
+        {
+            return reinterpret_cast<const std::uint64_t*>(reinterpret_cast<const char*>(&GetRecord(r)) + sizeof(RecordHeader));
+        }
+
+        std::string_view GetName(std::size_t r) const { return GetString(GetRecord(r).name); }
+
+        std::string_view GetTag(std::size_t r) const
+        {
+            const StringRef* tags = reinterpret_cast<const StringRef*>(data + GetHeader().tagsOffset);
+            return GetString(tags[GetRecord(r).tag]);
+        }
+
+        GapSequence GetGapSequence(std::size_t r) const
+        {
+            const std::uint64_t* gaps = GetGaps(r);
+            return GapSequence(std::string(GetName(r)), std::vector<unsigned long>(gaps, gaps + GetRecord(r).gapsCount));
+        }
+
+        // Record index of (sortingRange, gaps), -1 if not stored
+        long Find(unsigned long sortingRange, const std::vector<unsigned long>& gaps) const
+        {
+            if (!IsOpen()) return -1;
+
+            const Header& header = GetHeader();
+            const std::uint64_t* index = reinterpret_cast<const std::uint64_t*>(data + header.indexOffset);
+            const std::uint64_t hash = GetKeyHash(sortingRange, gaps.data(), gaps.size());
+
+            for (std::uint64_t slot = hash & (header.indexCapacity - 1); index[slot] != 0; slot = (slot + 1) & (header.indexCapacity - 1))
+            {
+                std::size_t r = index[slot] - 1;
+                const RecordHeader& record = GetRecord(r);
+                if (record.hash != hash || record.sortingRange != sortingRange || record.gapsCount != gaps.size()) continue;
+                if (std::equal(gaps.begin(), gaps.end(), GetGaps(r))) return static_cast<long>(r);
+            }
+            return -1;
+        }
+
+        // Sequences of a sorting range, optionally only of one algorithm tag
+        std::vector<GapSequence> GetGapSequences(unsigned long sortingRange, const std::string& tag = "") const
+        {
+            std::vector<GapSequence> sequences;
+            for (std::size_t r = 0; r < Size(); r++)
+            {
+                if (GetRecord(r).sortingRange != sortingRange || (!tag.empty() && GetTag(r) != tag)) continue;
+                sequences.push_back(GetGapSequence(r));
+            }
+            return sequences;
+        }
+
+        private:
+        const char* data = nullptr;
+        std::size_t size = 0;
+
+        const Header& GetHeader() const { return *reinterpret_cast<const Header*>(data); }
+
+        std::string_view GetString(const StringRef& ref) const
+        {
+            return std::string_view(data + GetHeader().stringsOffset + ref.offset, ref.length);
+        }
+
+        // Section of count elements at offset lies inside the file, without overflowing
+        bool IsInFile(std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize) const
+        {
+            return offset % 8 == 0 && offset <= size && count <= (size - offset) / elementSize;
+        }
+
+        static bool IsInStrings(const StringRef& ref, const Header& header)
+        {
+            return ref.offset <= header.stringsBytes && ref.length <= header.stringsBytes - ref.offset;
+        }
+
+        // Header, sections and every record are checked once on open, so accessors never read outside the mapping
+        bool IsValid() const
+        {
+            const Header& header = GetHeader();
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) return false;
+            if (header.recordSize != sizeof(RecordHeader) + header.gapsWidth * sizeof(std::uint64_t)) return false;
+            if (header.indexCapacity == 0 || (header.indexCapacity & (header.indexCapacity - 1)) != 0) return false;
+            if (header.indexCapacity <= header.recordsCount) return false;
+            if (!IsInFile(header.recordsOffset, header.recordsCount, header.recordSize)
+                || !IsInFile(header.indexOffset, header.indexCapacity, sizeof(std::uint64_t))
+                || !IsInFile(header.tagsOffset, header.tagsCount, sizeof(StringRef))
+                || !IsInFile(header.stringsOffset, header.stringsBytes, 1)) return false;
+
+            const StringRef* tags = reinterpret_cast<const StringRef*>(data + header.tagsOffset);
+            for (std::uint64_t t = 0; t < header.tagsCount; t++)
+            {
+                if (!IsInStrings(tags[t], header)) return false;
+            }
+
+            for (std::uint64_t r = 0; r < header.recordsCount; r++)
+            {
+                const RecordHeader& record = GetRecord(r);
+                if (!IsInStrings(record.name, header) || record.tag >= header.tagsCount || record.gapsCount > header.gapsWidth) return false;
+            }
+
+            //Lookups stop at an empty slot, so at least one must exist
+            const std::uint64_t* index = reinterpret_cast<const std::uint64_t*>(data + header.indexOffset);
+            bool hasEmptySlot = false;
+            for (std::uint64_t slot = 0; slot < header.indexCapacity; slot++)
+            {
+                if (index[slot] > header.recordsCount) return false;
+                hasEmptySlot = hasEmptySlot || index[slot] == 0;
+            }
+            return hasEmptySlot;
+        }
+    };
+
+    // Candidates file name in the format of files::SaveGapsToFile
+    std::string GetTextFileName(unsigned long sortingRange, const std::string& tag)
+    {
+        return "CandidateGapSequences" + std::to_string(sortingRange) + "_" + tag + ".txt";
+    }
+
+    // Text candidates files (directories are searched recursively for .txt) into one deduplicated store,
+    // with fitness statistics of sequences known to the cache
+    bool ConvertTextToStore(const std::vector<std::string>& paths, const std::string& storePath, const FitnessCache& cache = sharedFitnessCache)
+    {
+        std::vector<std::string> textFiles = files::GetTextFiles(paths);
+        std::vector<files::Candidate> candidates = files::LoadCandidates(textFiles);
+
+        CandidateStoreBuilder builder;
+        for (const files::Candidate& candidate : candidates) builder.Add(candidate.sortingRange, candidate.tag, candidate.gapSequence);
+        builder.AddFitnessFromCache(cache);
+
+        std::cout << "Converted " << textFiles.size() << " files into " << builder.Size() << " unique candidates\n";
+        return builder.Write(storePath);
+    }
+
+    // Every record back to text, one CandidateGapSequences<range>_<tag>.txt per (sortingRange, tag)
+    bool ConvertStoreToText(const std::string& storePath, const std::string& outputDirectory)
+    {
+        CandidateStore store(storePath);
+        if (!store.IsOpen()) return false;
+
+        std::filesystem::create_directories(outputDirectory);
+        std::unordered_map<std::string, std::string> contents;
+        for (std::size_t r = 0; r < store.Size(); r++)
+        {
+            std::string& content = contents[GetTextFileName(store.GetRecord(r).sortingRange, std::string(store.GetTag(r)))];
+            content += std::string(store.GetName(r)) + ": ";
+            for (std::uint32_t g = 0; g < store.GetRecord(r).gapsCount; g++) content += std::to_string(store.GetGaps(r)[g]) + " ";
+            content += "\n";
+        }
+
+        for (const auto& content : contents)
+        {
+            std::ofstream file(outputDirectory + "/" + content.first, std::ios::trunc);
+            if (!file.is_open())
+            {
+                std::cerr << "ERROR: Could not open file for writing: " << outputDirectory + "/" + content.first << std::endl;
+                return false;
+            }
+            file << content.second;
+        }
+
+        std::cout << "Exported " << store.Size() << " candidates into " << contents.size() << " files in " << outputDirectory << "\n";
+        return true;
+    }
+}
+
+
+#endif // !CANDIDATE_STORE_HPP
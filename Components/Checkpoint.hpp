@@ -0,0 +1,298 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <cstdint>
+#include <type_traits>
+#include "Utilis.hpp"
+#include "Shellsort.hpp"
+#include "ShellsortComparisons.hpp"
+#include "InputDistributions.hpp"
+#include "FitnessCache.hpp"
+
+// Binary checkpoints of endless searches - Results/Checkpoints/<algorithm>_<sortingRange>.ckpt holds the search
+// state with run seed, dataset counter and RNG state, FitnessCache.ckpt holds the shared fitness cache.
+// Files are written to a temporary file and renamed, so a crash leaves the previous checkpoint intact.
+// The fitness function and input mixture are recorded, a checkpoint of a different configuration is not resumed
+namespace checkpoint
+{
+    // Generations between checkpoints (0 - no checkpoints), searches resume from their checkpoint when resume is set
+    long interval = 10;
+    bool resume = false;
+    std::string directory = "Results/Checkpoints";
+
+    const std::uint64_t STATE_MAGIC = 0x3274617453535353ULL;
+    const std::uint64_t CACHE_MAGIC = 0x3265686361435353ULL;
+
+    struct SearchState
+    {
+        // Generation to start from on resume
+        long generation = 1;
+        std::vector<GapSequence> population;
+        std::vector<GapSequence> alreadyFound;
+        long stagnatedGenerations = 0;
+        std::vector<int> trialCounters; //ABC food sources, same order as population
+
+        SearchState() {}
+
+        SearchState(long generation, std::vector<GapSequence> population, const GapSequenceSet& alreadyFound,
+            long stagnatedGenerations = 0, std::vector<int> trialCounters = {}) :
+            generation(generation),
+            population(population),
+            alreadyFound(alreadyFound.begin(), alreadyFound.end()),
+            stagnatedGenerations(stagnatedGenerations),
+            trialCounters(trialCounters)
+        {
+        }
+    };
+
+    class BinaryWriter
+    {
+        public:
+        BinaryWriter(std::ostream& stream) : stream(stream) {}
+
+        template <typename T>
+        void Put(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values are written raw");
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        void PutVector(const std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values are written raw");
+            Put(static_cast<std::uint64_t>(values.size()));
+            stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        }
+
+        void PutString(const std::string& value)
+        {
+            Put(static_cast<std::uint64_t>(value.size()));
+            stream.write(value.data(), value.size());
+        }
+
+        void PutSequences(const std::vector<GapSequence>& sequences)
+        {
+            Put(static_cast<std::uint64_t>(sequences.size()));
+            for (const GapSequence& gs : sequences)
+            {
+                PutString(gs.name);
+                PutVector(gs.gaps);
+            }
+        }
+
+        private:
+        std::ostream& stream;
+    };
+
+    class BinaryReader
+    {
+        public:
+        BinaryReader(std::istream& stream) : stream(stream) {}
+
+        bool Failed() const { return !stream; }
+
+        template <typename T>
+        T Get()
+        {
+            T value{};
+            stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        std::vector<T> GetVector()
+        {
+            std::uint64_t size = Get<std::uint64_t>();
+            if (!stream || size > MAX_ELEMENTS) { stream.setstate(std::ios::failbit); return {}; }
+            std::vector<T> values(size);
+            stream.read(reinterpret_cast<char*>(values.data()), size * sizeof(T));
+            return values;
+        }
+
+        std::string GetString()
+        {
+            std::vector<char> chars = GetVector<char>();
+            return std::string(chars.begin(), chars.end());
+        }
+
+        std::vector<GapSequence> GetSequences()
+        {
+            std::uint64_t size = Get<std::uint64_t>();
+            std::vector<GapSequence> sequences;
+            for (std::uint64_t s = 0; s < size && stream; s++)
+            {
+                std::string name = GetString();
+                sequences.push_back(GapSequence(name, GetVector<unsigned long>()));
+            }
+            return sequences;
+        }
+
+        private:
+        // Sanity limit for counts read from a damaged file
+        static const std::uint64_t MAX_ELEMENTS = 1ULL << 32;
+        std::istream& stream;
+    };
+
+    std::string GetStatePath(const std::string& algorithmName, unsigned long sortingRange)
+    {
+        return directory + "/" + algorithmName + "_" + std::to_string(sortingRange) + ".ckpt";
+    }
+
+    std::string GetCachePath()
+    {
+        return directory + "/FitnessCache.ckpt";
+    }
+
+    // Settings that change what a fitness value means - fitness function and input mixture
+    std::string GetConfiguration()
+    {
+        return "fitness=" + fitnessFunction.ToString() + ";inputs=" + distributions::MixtureToString(utilis::inputMixture);
+    }
+
+    bool IsDue(long generation)
+    {
+        return interval > 0 && generation % interval == 0;
+    }
+
+    // Temporary file is unique per thread, so islands can save at the same time
+    bool WriteAtomically(const std::string& path, const std::function<void(BinaryWriter&)>& write)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        std::string temporaryPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        bool written = false;
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                std::cerr << "ERROR: Could not open checkpoint for writing: " << temporaryPath << std::endl;
+                return false;
+            }
+            BinaryWriter writer(file);
+            write(writer);
+            file.flush();
+            written = static_cast<bool>(file);
+        }
+
+        if (written) std::filesystem::rename(temporaryPath, path, error);
+        if (written && !error) return true;
+
+        std::cerr << "ERROR: Could not write checkpoint: " << path << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    bool SaveFitnessCache(const FitnessCache& cache)
+    {
+        return WriteAtomically(GetCachePath(), [&](BinaryWriter& writer) {
+            writer.Put(CACHE_MAGIC);
+            writer.Put(static_cast<std::uint64_t>(cache.Size()));
+            cache.ForEachEntry([&](unsigned long sortingRange, const std::vector<unsigned long>& gaps, const CachedFitness& fitness) {
+                writer.Put(static_cast<std::uint64_t>(sortingRange));
+                writer.PutVector(gaps);
+                writer.Put(fitness);
+                });
+            });
+    }
+
+    // Entries are written as they are visited, the count in the header is only a hint for a concurrently filled cache
+    bool LoadFitnessCache(FitnessCache& cache)
+    {
+        std::ifstream file(GetCachePath(), std::ios::binary);
+        if (!file.is_open()) return false;
+
+        BinaryReader reader(file);
+        if (reader.Get<std::uint64_t>() != CACHE_MAGIC) return false;
+        reader.Get<std::uint64_t>();
+
+        for (;;)
+        {
+            std::uint64_t sortingRange = reader.Get<std::uint64_t>();
+            if (reader.Failed()) break;
+            std::vector<unsigned long> gaps = reader.GetVector<unsigned long>();
+            CachedFitness fitness = reader.Get<CachedFitness>();
+            if (reader.Failed()) return false;
+            cache.SetEntry(static_cast<unsigned long>(sortingRange), gaps, fitness);
+        }
+        return true;
+    }
+
+    // Search state with the run seed, dataset counter and RNG state of the calling thread, then the fitness cache
+    bool Save(const std::string& algorithmName, unsigned long sortingRange, const SearchState& state, const FitnessCache& cache = sharedFitnessCache)
+    {
+        bool saved = WriteAtomically(GetStatePath(algorithmName, sortingRange), [&](BinaryWriter& writer) {
+            writer.Put(STATE_MAGIC);
+            writer.Put(static_cast<std::uint64_t>(sortingRange));
+            writer.PutString(GetConfiguration());
+            writer.Put(utilis::GetRunSeed());
+            writer.Put(utilis::datasetCounter.load());
+            writer.Put(utilis::commonRandomNumbers);
+            writer.Put(utilis::GetThreadGenerator().state);
+            writer.Put(state.generation);
+            writer.Put(state.stagnatedGenerations);
+            writer.PutSequences(state.population);
+            writer.PutSequences(state.alreadyFound);
+            writer.PutVector(state.trialCounters);
+            });
+
+        return saved && SaveFitnessCache(cache);
+    }
+
+    bool Load(const std::string& algorithmName, unsigned long sortingRange, SearchState& state, FitnessCache& cache = sharedFitnessCache)
+    {
+        std::ifstream file(GetStatePath(algorithmName, sortingRange), std::ios::binary);
+        if (!file.is_open()) return false;
+
+        BinaryReader reader(file);
+        if (reader.Get<std::uint64_t>() != STATE_MAGIC || reader.Get<std::uint64_t>() != sortingRange) return false;
+
+        std::string configuration = reader.GetString();
+        if (configuration != GetConfiguration())
+        {
+            std::cerr << "ERROR: Checkpoint " << GetStatePath(algorithmName, sortingRange) << " was written with " << configuration
+                << ", current run uses " << GetConfiguration() << " - not resuming" << std::endl;
+            return false;
+        }
+
+        std::uint64_t runSeed = reader.Get<std::uint64_t>();
+        std::uint64_t datasetCounter = reader.Get<std::uint64_t>();
+        bool commonRandomNumbers = reader.Get<bool>();
+        std::array<std::uint64_t, 4> generatorState = reader.Get<std::array<std::uint64_t, 4>>();
+
+        SearchState loaded;
+        loaded.generation = reader.Get<long>();
+        loaded.stagnatedGenerations = reader.Get<long>();
+        loaded.population = reader.GetSequences();
+        loaded.alreadyFound = reader.GetSequences();
+        loaded.trialCounters = reader.GetVector<int>();
+        if (reader.Failed() || loaded.population.empty())
+        {
+            std::cerr << "ERROR: Damaged checkpoint: " << GetStatePath(algorithmName, sortingRange) << std::endl;
+            return false;
+        }
+
+        //Generator is reseeded on run seed change, so its state is restored after
+        utilis::SetRunSeed(runSeed);
+        utilis::datasetCounter = datasetCounter;
+        utilis::commonRandomNumbers = commonRandomNumbers;
+        utilis::GetThreadGenerator().state = generatorState;
+
+        LoadFitnessCache(cache);
+        state = loaded;
+        std::cout << "Resumed " << algorithmName << " from checkpoint at generation " << state.generation
+            << " (run seed " << runSeed << ", " << cache.Size() << " cached sequences)\n";
+        return true;
+    }
+}
+
+
+#endif // !CHECKPOINT_HPP
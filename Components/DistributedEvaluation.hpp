@@ -0,0 +1,596 @@
+#ifndef DISTRIBUTED_EVALUATION_HPP
+#define DISTRIBUTED_EVALUATION_HPP
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <deque>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include <omp.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "Shellsort.hpp"
+#include "ShellsortComparisons.hpp"
+#include "InputDistributions.hpp"
+#include "Utilis.hpp"
+
+// Coordinator/worker evaluation over Unix or TCP sockets. Workers get batches of (gaps, dataset indices) together
+// with the run seed, so they rebuild the exact datasets of the coordinator and send back per-dataset statistics.
+// A worker announces its input mixture in Hello and is rejected unless it matches the coordinator's.
+// Addresses: "unix:/path/to/socket" or "tcp:host:port"
+namespace distributed
+{
+    enum class MessageType : std::uint32_t { Hello = 1, Batch = 2, Results = 3, Shutdown = 4, Rejected = 5 };
+
+    // Frames larger than this are treated as a broken connection
+    const std::uint64_t MAX_PAYLOAD_BYTES = 1ULL << 30;
+
+    class MessageWriter
+    {
+        public:
+        std::vector<char> buffer;
+
+        void Put(std::uint64_t value) { Append(&value, sizeof(value)); }
+        void Put(double value) { Append(&value, sizeof(value)); }
+        void Put(const std::string& value) { Put(static_cast<std::uint64_t>(value.size())); Append(value.data(), value.size()); }
+
+        private:
+        void Append(const void* data, std::size_t size)
+        {
+            const char* bytes = static_cast<const char*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+        }
+    };
+
+    class MessageReader
+    {
+        public:
+        bool failed = false;
+
+        MessageReader(const std::vector<char>& buffer) : buffer(buffer) {}
+
+        std::uint64_t GetU64() { std::uint64_t value = 0; Read(&value, sizeof(value)); return value; }
+        double GetDouble() { double value = 0.0; Read(&value, sizeof(value)); return value; }
+
+        std::string GetString()
+        {
+            std::uint64_t size = GetU64();
+            if (!CanHold(size, 1)) return "";
+            std::string value(size, '\0');
+            Read(value.data(), size);
+            return value;
+        }
+
+        // Element counts are checked against the remaining bytes before anything is allocated
+        bool CanHold(std::uint64_t count, std::size_t elementSize)
+        {
+            if (!failed && count > (buffer.size() - position) / elementSize) failed = true;
+            return !failed;
+        }
+
+        private:
+        const std::vector<char>& buffer;
+        std::size_t position = 0;
+
+        void Read(void* data, std::size_t size)
+        {
+            if (failed || buffer.size() - position < size) { failed = true; return; }
+            std::memcpy(data, buffer.data() + position, size);
+            position += size;
+        }
+    };
+
+    bool SendAll(int fd, const void* data, std::size_t size)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0)
+        {
+            ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+            if (sent <= 0) return false;
+            bytes += sent;
+            size -= static_cast<std::size_t>(sent);
+        }
+        return true;
+    }
+
+    bool ReceiveAll(int fd, void* data, std::size_t size)
+    {
+        char* bytes = static_cast<char*>(data);
+        while (size > 0)
+        {
+            ssize_t received = recv(fd, bytes, size, 0);
+            if (received <= 0) return false;
+            bytes += received;
+            size -= static_cast<std::size_t>(received);
+        }
+        return true;
+    }
+
+    // Frame: type, payload length, payload
+    bool SendMessage(int fd, MessageType type, const std::vector<char>& payload = {})
+    {
+        std::uint32_t typeValue = static_cast<std::uint32_t>(type);
+        std::uint64_t length = payload.size();
+        return SendAll(fd, &typeValue, sizeof(typeValue)) && SendAll(fd, &length, sizeof(length))
+            && SendAll(fd, payload.data(), payload.size());
+    }
+
+    bool ReceiveMessage(int fd, MessageType& type, std::vector<char>& payload)
+    {
+        std::uint32_t typeValue = 0;
+        std::uint64_t length = 0;
+        if (!ReceiveAll(fd, &typeValue, sizeof(typeValue)) || !ReceiveAll(fd, &length, sizeof(length))) return false;
+        if (length > MAX_PAYLOAD_BYTES) return false;
+
+        type = static_cast<MessageType>(typeValue);
+        payload.resize(length);
+        return ReceiveAll(fd, payload.data(), payload.size());
+    }
+
+    // Blocking calls on the socket fail after timeoutSeconds instead of waiting for a stalled peer
+    bool SetTimeout(int fd, int timeoutSeconds)
+    {
+        timeval timeout{};
+        timeout.tv_sec = timeoutSeconds;
+        return setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0
+            && setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == 0;
+    }
+
+    // Socket of the address, bound and listening or connected, -1 on failure
+    int OpenSocket(const std::string& address, bool listening)
+    {
+        if (address.rfind("unix:", 0) == 0)
+        {
+            std::string path = address.substr(5);
+            sockaddr_un socketAddress{};
+            if (path.empty() || path.size() >= sizeof(socketAddress.sun_path)) return -1;
+            socketAddress.sun_family = AF_UNIX;
+            std::strncpy(socketAddress.sun_path, path.c_str(), sizeof(socketAddress.sun_path) - 1);
+
+            int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd < 0) return -1;
+            if (listening) unlink(path.c_str());
+            int status = listening
+                ? bind(fd, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress))
+                : connect(fd, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress));
+            if (status != 0 || (listening && listen(fd, 64) != 0)) { close(fd); return -1; }
+            return fd;
+        }
+
+        if (address.rfind("tcp:", 0) == 0)
+        {
+            std::string hostPort = address.substr(4);
+            std::size_t colon = hostPort.rfind(':');
+            if (colon == std::string::npos) return -1;
+            std::string host = hostPort.substr(0, colon);
+            std::string port = hostPort.substr(colon + 1);
+
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = listening ? AI_PASSIVE : 0;
+            addrinfo* addresses = nullptr;
+            if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &addresses) != 0) return -1;
+
+            int fd = -1;
+            for (addrinfo* a = addresses; a != nullptr && fd < 0; a = a->ai_next)
+            {
+                fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+                if (fd < 0) continue;
+
+                int enable = 1;
+                if (listening) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+                int status = listening ? bind(fd, a->ai_addr, a->ai_addrlen) : connect(fd, a->ai_addr, a->ai_addrlen);
+                if (status != 0 || (listening && listen(fd, 64) != 0)) { close(fd); fd = -1; }
+            }
+            freeaddrinfo(addresses);
+            return fd;
+        }
+
+        std::cerr << "ERROR: Unknown address (expected unix:path or tcp:host:port): " << address << std::endl;
+        return -1;
+    }
+
+    struct Task
+    {
+        std::vector<unsigned long> gaps;
+        std::vector<std::uint64_t> datasets;
+    };
+
+    // Per-dataset results of every task, datasets rebuilt from the run seed
+    std::vector<std::vector<Result>> EvaluateTasks(unsigned long sortingRange, const std::vector<Task>& tasks)
+    {
+        std::vector<std::pair<std::size_t, std::size_t>> samples;
+        std::vector<std::vector<Result>> results(tasks.size());
+        for (std::size_t t = 0; t < tasks.size(); t++)
+        {
+            results[t].resize(tasks[t].datasets.size());
+            for (std::size_t d = 0; d < tasks[t].datasets.size(); d++) samples.push_back({ t, d });
+        }
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (long s = 0; s < static_cast<long>(samples.size()); s++)
+        {
+            const Task& task = tasks[samples[s].first];
+            std::vector<int> data = utilis::GetSortingData(sortingRange, task.datasets[samples[s].second]);
+            results[samples[s].first][samples[s].second] = MeasureShellsort_Full(data, GapSequence("Task", task.gaps));
+        }
+
+        return results;
+    }
+
+    std::vector<char> SerializeBatch(std::uint64_t batchId, unsigned long sortingRange, const std::vector<Task>& tasks)
+    {
+        MessageWriter writer;
+        writer.Put(batchId);
+        writer.Put(static_cast<std::uint64_t>(sortingRange));
+        writer.Put(utilis::GetRunSeed());
+        writer.Put(static_cast<std::uint64_t>(tasks.size()));
+        for (const Task& task : tasks)
+        {
+            writer.Put(static_cast<std::uint64_t>(task.gaps.size()));
+            for (unsigned long gap : task.gaps) writer.Put(static_cast<std::uint64_t>(gap));
+            writer.Put(static_cast<std::uint64_t>(task.datasets.size()));
+            for (std::uint64_t dataset : task.datasets) writer.Put(dataset);
+        }
+        return writer.buffer;
+    }
+
+    std::vector<char> SerializeResults(std::uint64_t batchId, const std::vector<std::vector<Result>>& results)
+    {
+        MessageWriter writer;
+        writer.Put(batchId);
+        writer.Put(static_cast<std::uint64_t>(results.size()));
+        for (const std::vector<Result>& taskResults : results)
+        {
+            writer.Put(static_cast<std::uint64_t>(taskResults.size()));
+            for (const Result& r : taskResults)
+            {
+                writer.Put(r.time);
+                writer.Put(r.comparisons);
+                writer.Put(r.loops);
+                writer.Put(r.operations);
+                writer.Put(r.moves);
+            }
+        }
+        return writer.buffer;
+    }
+
+    bool DeserializeResults(const std::vector<char>& payload, std::uint64_t& batchId, std::vector<std::vector<Result>>& results)
+    {
+        MessageReader reader(payload);
+        batchId = reader.GetU64();
+        std::uint64_t tasksCount = reader.GetU64();
+        if (!reader.CanHold(tasksCount, sizeof(std::uint64_t))) return false;
+
+        results.assign(tasksCount, {});
+        for (std::vector<Result>& taskResults : results)
+        {
+            std::uint64_t samplesCount = reader.GetU64();
+            if (!reader.CanHold(samplesCount, 5 * sizeof(double))) return false;
+            taskResults.resize(samplesCount);
+            for (Result& r : taskResults)
+            {
+                r.time = reader.GetDouble();
+                r.comparisons = reader.GetDouble();
+                r.loops = reader.GetDouble();
+                r.operations = reader.GetDouble();
+                r.moves = reader.GetDouble();
+            }
+        }
+        return !reader.failed;
+    }
+
+    // Worker process loop - reconnects when the coordinator goes away, returns on Shutdown
+    void RunWorker(const std::string& address, int reconnectSeconds = 5)
+    {
+        for (;;)
+        {
+            int fd = OpenSocket(address, false);
+            if (fd < 0)
+            {
+                std::this_thread::sleep_for(std::chrono::seconds(reconnectSeconds));
+                continue;
+            }
+
+            MessageWriter hello;
+            hello.Put(static_cast<std::uint64_t>(omp_get_max_threads()));
+            hello.Put(distributions::MixtureToString(utilis::inputMixture));
+            bool connected = SendMessage(fd, MessageType::Hello, hello.buffer);
+            if (connected) std::cout << "Worker connected to " << address << "\n";
+
+            MessageType type;
+            std::vector<char> payload;
+            while (connected && ReceiveMessage(fd, type, payload))
+            {
+                if (type == MessageType::Shutdown) { close(fd); return; }
+                if (type == MessageType::Rejected)
+                {
+                    std::cerr << "ERROR: Coordinator at " << address << " rejected this worker: " << MessageReader(payload).GetString() << std::endl;
+                    close(fd);
+                    return;
+                }
+                if (type != MessageType::Batch) continue;
+
+                MessageReader reader(payload);
+                std::uint64_t batchId = reader.GetU64();
+                unsigned long sortingRange = static_cast<unsigned long>(reader.GetU64());
+                std::uint64_t runSeed = reader.GetU64();
+                std::uint64_t tasksCount = reader.GetU64();
+                if (!reader.CanHold(tasksCount, 2 * sizeof(std::uint64_t))) break;
+
+                std::vector<Task> tasks(tasksCount);
+                for (Task& task : tasks)
+                {
+                    std::uint64_t gapsCount = reader.GetU64();
+                    if (!reader.CanHold(gapsCount, sizeof(std::uint64_t))) break;
+                    for (std::uint64_t g = 0; g < gapsCount; g++) task.gaps.push_back(static_cast<unsigned long>(reader.GetU64()));
+                    std::uint64_t datasetsCount = reader.GetU64();
+                    if (!reader.CanHold(datasetsCount, sizeof(std::uint64_t))) break;
+                    for (std::uint64_t d = 0; d < datasetsCount; d++) task.datasets.push_back(reader.GetU64());
+                }
+                if (reader.failed) break;
+
+                if (runSeed != utilis::GetRunSeed()) utilis::SetRunSeed(runSeed);
+                connected = SendMessage(fd, MessageType::Results, SerializeResults(batchId, EvaluateTasks(sortingRange, tasks)));
+            }
+
+            close(fd);
+            std::cout << "Worker disconnected from " << address << "\n";
+        }
+    }
+
+    // Listens for workers, which may join or leave at any time. Batches of a worker that leaves are sent again,
+    // without any worker connected batches are evaluated locally
+    class Coordinator
+    {
+        public:
+        // Sequences per batch sent to a worker
+        std::size_t batchSize = 4;
+        // A worker that stalls for this long in the middle of a message (or of its Hello) is dropped
+        int timeoutSeconds = 30;
+        // A worker that does not reply to a batch for this long is dropped and its batch goes to another one
+        int batchTimeoutSeconds = 600;
+
+        Coordinator(const std::string& address) : address(address)
+        {
+            listenFd = OpenSocket(address, true);
+            if (listenFd < 0) std::cerr << "ERROR: Could not listen on " << address << ", evaluating locally" << std::endl;
+            //A connection reset between poll and accept must not block the coordinator
+            else fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+        }
+
+        ~Coordinator()
+        {
+            for (Worker& worker : workers)
+            {
+                SendMessage(worker.fd, MessageType::Shutdown);
+                close(worker.fd);
+            }
+            if (listenFd >= 0) close(listenFd);
+            if (address.rfind("unix:", 0) == 0) unlink(address.substr(5).c_str());
+        }
+
+        Coordinator(const Coordinator&) = delete;
+        Coordinator& operator=(const Coordinator&) = delete;
+
+        std::size_t GetWorkersCount() const { return workers.size(); }
+
+        // Per-dataset results of every task, in task order
+        std::vector<std::vector<Result>> Evaluate(unsigned long sortingRange, const std::vector<Task>& tasks)
+        {
+            std::vector<std::vector<Result>> results(tasks.size());
+            std::vector<std::vector<Task>> batches;
+            for (std::size_t t = 0; t < tasks.size(); t += batchSize)
+            {
+                batches.push_back(std::vector<Task>(tasks.begin() + t, tasks.begin() + std::min(t + batchSize, tasks.size())));
+            }
+
+            std::deque<std::size_t> pending;
+            for (std::size_t b = 0; b < batches.size(); b++) pending.push_back(b);
+            std::vector<bool> done(batches.size(), false);
+            std::size_t remaining = batches.size();
+
+            auto storeBatch = [&](std::size_t b, const std::vector<std::vector<Result>>& batchResults) {
+                for (std::size_t k = 0; k < batchResults.size(); k++) results[b * batchSize + k] = batchResults[k];
+                done[b] = true;
+                remaining--;
+                };
+
+            while (remaining > 0)
+            {
+                const auto now = std::chrono::steady_clock::now();
+                for (std::size_t w = workers.size(); w-- > 0;)
+                {
+                    if (workers[w].batch >= 0 && now - workers[w].dispatched > std::chrono::seconds(batchTimeoutSeconds)) DropWorker(w, pending, done);
+                }
+
+                for (std::size_t w = 0; w < workers.size() && !pending.empty(); w++)
+                {
+                    if (workers[w].batch >= 0) continue;
+                    std::size_t b = pending.front();
+                    pending.pop_front();
+                    workers[w].batch = static_cast<long>(b);
+                    workers[w].dispatched = std::chrono::steady_clock::now();
+                    if (!SendMessage(workers[w].fd, MessageType::Batch, SerializeBatch(b, sortingRange, batches[b]))) DropWorker(w--, pending, done);
+                }
+
+                if (workers.empty() && !pending.empty())
+                {
+                    std::size_t b = pending.front();
+                    pending.pop_front();
+                    storeBatch(b, EvaluateTasks(sortingRange, batches[b]));
+                }
+
+                std::vector<pollfd> descriptors;
+                if (listenFd >= 0) descriptors.push_back(pollfd{ listenFd, POLLIN, 0 });
+                for (const Worker& worker : workers) descriptors.push_back(pollfd{ worker.fd, POLLIN, 0 });
+                if (descriptors.empty() || poll(descriptors.data(), descriptors.size(), workers.empty() ? 0 : 1000) <= 0) continue;
+
+                std::size_t offset = listenFd >= 0 ? 1 : 0;
+                for (std::size_t w = workers.size(); w-- > 0;)
+                {
+                    if (descriptors[offset + w].revents == 0) continue;
+
+                    MessageType type;
+                    std::vector<char> payload;
+                    std::uint64_t batchId = 0;
+                    std::vector<std::vector<Result>> batchResults;
+                    if (!ReceiveMessage(workers[w].fd, type, payload) || type != MessageType::Results
+                        || !DeserializeResults(payload, batchId, batchResults)
+                        || static_cast<long>(batchId) != workers[w].batch || !IsCompleteReply(batches[batchId], batchResults))
+                    {
+                        DropWorker(w, pending, done);
+                        continue;
+                    }
+
+                    workers[w].batch = -1;
+                    if (!done[batchId]) storeBatch(batchId, batchResults);
+                }
+
+                if (listenFd >= 0 && (descriptors[0].revents & POLLIN)) AcceptWorker();
+            }
+
+            return results;
+        }
+
+        private:
+        struct Worker
+        {
+            int fd = -1;
+            std::uint64_t threads = 0;
+            long batch = -1;
+            std::chrono::steady_clock::time_point dispatched;
+        };
+
+        std::string address;
+        int listenFd = -1;
+        std::vector<Worker> workers;
+
+        void AcceptWorker()
+        {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0) return;
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+            if (!SetTimeout(fd, timeoutSeconds))
+            {
+                close(fd);
+                return;
+            }
+
+            MessageType type;
+            std::vector<char> payload;
+            if (!ReceiveMessage(fd, type, payload) || type != MessageType::Hello)
+            {
+                close(fd);
+                return;
+            }
+
+            MessageReader reader(payload);
+            Worker worker;
+            worker.fd = fd;
+            worker.threads = reader.GetU64();
+            std::string mixture = reader.GetString();
+            const std::string expected = distributions::MixtureToString(utilis::inputMixture);
+            if (reader.failed || mixture != expected)
+            {
+                std::string reason = "input mixture " + mixture + " differs from " + expected + " (set the same --inputs)";
+                std::cerr << "ERROR: Worker rejected, " << reason << std::endl;
+                MessageWriter rejected;
+                rejected.Put(reason);
+                SendMessage(fd, MessageType::Rejected, rejected.buffer);
+                close(fd);
+                return;
+            }
+            workers.push_back(worker);
+            std::cout << "Worker joined (" << worker.threads << " threads), workers: " << workers.size() << "\n";
+        }
+
+        // Reply holds a result for every dataset of every task of the batch
+        static bool IsCompleteReply(const std::vector<Task>& batch, const std::vector<std::vector<Result>>& batchResults)
+        {
+            if (batchResults.size() != batch.size()) return false;
+            for (std::size_t k = 0; k < batch.size(); k++)
+            {
+                if (batchResults[k].size() != batch[k].datasets.size()) return false;
+            }
+            return true;
+        }
+
+        void DropWorker(std::size_t w, std::deque<std::size_t>& pending, const std::vector<bool>& done)
+        {
+            if (workers[w].batch >= 0 && !done[workers[w].batch]) pending.push_front(static_cast<std::size_t>(workers[w].batch));
+            close(workers[w].fd);
+            workers.erase(workers.begin() + w);
+            std::cout << "Worker left, workers: " << workers.size() << "\n";
+        }
+    };
+}
+
+// Same contract as CompareShellsorts, sequences are evaluated by the workers of the coordinator
+std::vector<Result> CompareShellsorts_Distributed(distributed::Coordinator& coordinator, unsigned long sortingRange, std::vector<GapSequence> gapSequences, int iterations)
+{
+    int sortsCount = gapSequences.size();
+
+    std::vector<std::uint64_t> datasets;
+    for (int i = 0; i < iterations; i++) datasets.push_back(utilis::GetDatasetIndexForIteration(i));
+
+    std::vector<distributed::Task> tasks;
+    for (const GapSequence& gs : gapSequences) tasks.push_back(distributed::Task{ gs.gaps, datasets });
+    std::vector<std::vector<Result>> samples = coordinator.Evaluate(sortingRange, tasks);
+
+    std::vector<Result> avgResults(sortsCount);
+    for (int j = 0; j < sortsCount; j++)
+    {
+        avgResults[j].gapSequence = gapSequences[j];
+        for (const Result& r : samples[j])
+        {
+            avgResults[j].time += r.time;
+            avgResults[j].comparisons += r.comparisons;
+            avgResults[j].loops += r.loops;
+            avgResults[j].operations += r.operations;
+            avgResults[j].moves += r.moves;
+        }
+    }
+
+    // Getting best result of every iteration for wins count
+    for (int i = 0; i < iterations; i++)
+    {
+        int winner = 0;
+        for (int j = 1; j < sortsCount; j++)
+        {
+            if (samples[j][i].GetFitnessScore() < samples[winner][i].GetFitnessScore()) winner = j;
+        }
+        if (sortsCount > 0) for (Result& r : avgResults) if (r.gapSequence == gapSequences[winner]) { r.wins++; }
+    }
+
+    // Average the results over the number of iterations
+    for (Result& r : avgResults)
+    {
+        r.time = r.time / iterations;
+        r.comparisons = r.comparisons / iterations;
+        r.loops = r.loops / iterations;
+        r.operations = r.operations / iterations;
+        r.moves = r.moves / iterations;
+        r.samples = iterations;
+    }
+
+    // Sort results return order by fitness score
+    std::sort(avgResults.begin(), avgResults.end(), [](const Result& a, const Result& b) {
+        return a.GetFitnessScore() < b.GetFitnessScore();
+        });
+
+    return avgResults;
+}
+
+
+#endif // !DISTRIBUTED_EVALUATION_HPP
@@ -4,7 +4,19 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <charconv>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <omp.h>
 #include "Utilis.hpp"
 #include "Shellsort.hpp"
 
@@ -31,48 +43,310 @@ namespace files
     }
 
 
-    std::vector<GapSequence> GetGapsFromFile(std::string fileName)
+    // Read-only mapping of a whole file, empty view if the file is missing or empty
+    class MappedFile
+    {
+        public:
+        MappedFile(const std::string& path)
+        {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+            {
+                void* mapped = mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped != MAP_FAILED)
+                {
+                    data = static_cast<const char*>(mapped);
+                    size = static_cast<std::size_t>(fileStat.st_size);
+                    madvise(mapped, size, MADV_SEQUENTIAL);
+                }
+            }
+            close(fd);
+        }
+
+        ~MappedFile()
+        {
+            if (data != nullptr) munmap(const_cast<char*>(data), size);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        std::string_view GetView() const { return std::string_view(data != nullptr ? data : "", size); }
+
+        private:
+        const char* data = nullptr;
+        std::size_t size = 0;
+    };
+
+    // Calls onLine(name, gaps) for every line "name: gap gap gap ..." of a candidates file content, gaps end
+    // at the next ':' like in SplitString. The gaps buffer is reused between lines.
+    // Returns the number of tokens that are not gaps
+    template <typename OnLine>
+    std::size_t ParseGaps(std::string_view content, OnLine&& onLine)
+    {
+        std::size_t invalidTokens = 0;
+        std::vector<unsigned long> gaps;
+        std::size_t lineBegin = 0;
+        while (lineBegin < content.size())
+        {
+            std::size_t lineEnd = content.find('\n', lineBegin);
+            if (lineEnd == std::string_view::npos) lineEnd = content.size();
+            std::string_view line = content.substr(lineBegin, lineEnd - lineBegin);
+            lineBegin = lineEnd + 1;
+
+            std::size_t colon = line.find(':');
+            if (colon == std::string_view::npos || colon == 0) continue;
+            std::string_view strGaps = line.substr(colon + 1);
+            strGaps = strGaps.substr(0, strGaps.find(':'));
+            if (!strGaps.empty() && strGaps.back() == '\r') strGaps.remove_suffix(1);
+            if (strGaps.empty()) continue;
+
+            gaps.clear();
+            const char* it = strGaps.data();
+            const char* end = strGaps.data() + strGaps.size();
+            while (it < end)
+            {
+                if (*it == ' ' || *it == '\t' || *it == '\r') { it++; continue; }
+
+                const char* tokenEnd = it;
+                while (tokenEnd < end && *tokenEnd != ' ' && *tokenEnd != '\t' && *tokenEnd != '\r') tokenEnd++;
+
+                unsigned long gap = 0;
+                std::from_chars_result result = std::from_chars(it, tokenEnd, gap);
+                if (result.ec == std::errc() && result.ptr == tokenEnd) gaps.push_back(gap);
+                else invalidTokens++;
+                it = tokenEnd;
+            }
+            onLine(line.substr(0, colon), gaps);
+        }
+        return invalidTokens;
+    }
+
+    // Sequences of a candidates file at any path, e.g. inside Results/Backups
+    std::vector<GapSequence> GetGapsFromPath(std::string path)
     {
         std::vector<GapSequence> gapsFromFile;
 
-        std::string path = "Results/" + fileName;
-        std::ifstream file(path);
-        if (file.is_open())
+        MappedFile file(path);
+        std::size_t invalidTokens = ParseGaps(file.GetView(), [&](std::string_view name, const std::vector<unsigned long>& gaps)
+        {
+            gapsFromFile.push_back(GapSequence(std::string(name), gaps));
+        });
+        if (invalidTokens > 0) printf("WARNING: Skipped %zu invalid gap values in file '%s'.\n", invalidTokens, path.c_str());
+
+        return gapsFromFile;
+    }
+
+    std::vector<GapSequence> GetGapsFromFile(std::string fileName)
+    {
+        return GetGapsFromPath("Results/" + fileName);
+    }
+
+    // "CandidateGapSequences1000_GAv5.txt" -> (1000, "GAv5"), "BestGapsSequences1000.txt" -> (1000, "BestGapsSequences")
+    std::pair<unsigned long, std::string> ParseFileName(const std::string& fileName)
+    {
+        std::string stem = std::filesystem::path(fileName).stem().string();
+        std::size_t digitsBegin = stem.find_first_of("0123456789");
+        if (digitsBegin == std::string::npos) return { 0, stem };
+        std::size_t digitsEnd = stem.find_first_not_of("0123456789", digitsBegin);
+
+        unsigned long sortingRange = std::stoul(stem.substr(digitsBegin, digitsEnd - digitsBegin));
+        if (digitsEnd != std::string::npos && stem[digitsEnd] == '_') return { sortingRange, stem.substr(digitsEnd + 1) };
+        return { sortingRange, stem.substr(0, digitsBegin) };
+    }
+
+    // Text files of the given paths, directories are searched recursively for .txt, sorted for a stable order
+    std::vector<std::string> GetTextFiles(const std::vector<std::string>& paths)
+    {
+        std::vector<std::string> textFiles;
+        for (const std::string& path : paths)
         {
-            std::string line;
-            while (std::getline(file, line))
+            if (!std::filesystem::is_directory(path)) { textFiles.push_back(path); continue; }
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
             {
-                if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+                if (entry.is_regular_file() && entry.path().extension() == ".txt") textFiles.push_back(entry.path().string());
+            }
+        }
+        std::sort(textFiles.begin(), textFiles.end());
+        return textFiles;
+    }
 
-                if (line.empty()) continue;
+    struct Candidate
+    {
+        unsigned long sortingRange;
+        std::string tag; //algorithm that found the sequence, from the file name
+        GapSequence gapSequence;
+    };
 
-                std::vector<std::string> splited = utilis::SplitString(line, ":");
-                if (splited.size() < 2) continue;
+    // Every candidates file under the paths (Results and Results/Backups by default), mapped and parsed in parallel.
+    // Deduplicated by (sortingRange, gaps), the first occurrence in file order is kept
+    std::vector<Candidate> LoadCandidates(const std::vector<std::string>& paths = { "Results" })
+    {
+        //Lines stay views into the mapped files until they are known to be unique
+        struct ParsedLine
+        {
+            std::string_view name;
+            std::size_t gapsBegin;
+            std::size_t gapsCount;
+            std::size_t hash;
+        };
+        struct ParsedFile
+        {
+            std::unique_ptr<MappedFile> file;
+            unsigned long sortingRange = 0;
+            std::vector<ParsedLine> lines;
+            std::vector<unsigned long> gaps;
+        };
 
-                std::string sequenceName = splited[0];
-                std::vector<std::string> strGaps = utilis::SplitString(splited[1], " ");
+        std::vector<std::string> textFiles = GetTextFiles(paths);
+        std::vector<ParsedFile> parsed(textFiles.size());
 
-                std::vector<unsigned long> gaps;
-                for (const std::string& gap : strGaps)
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (long f = 0; f < static_cast<long>(textFiles.size()); f++)
+        {
+            ParsedFile& pf = parsed[f];
+            pf.file = std::make_unique<MappedFile>(textFiles[f]);
+            pf.sortingRange = ParseFileName(textFiles[f]).first;
+            std::size_t invalidTokens = ParseGaps(pf.file->GetView(), [&](std::string_view name, const std::vector<unsigned long>& gaps)
+            {
+                if (gaps.empty()) return;
+                std::size_t hash = utilis::SplitMix64(GapSequenceHash::HashGaps(gaps) ^ pf.sortingRange);
+                pf.lines.push_back(ParsedLine{ name, pf.gaps.size(), gaps.size(), hash });
+                pf.gaps.insert(pf.gaps.end(), gaps.begin(), gaps.end());
+            });
+            if (invalidTokens > 0) printf("WARNING: Skipped %zu invalid gap values in file '%s'.\n", invalidTokens, textFiles[f].c_str());
+        }
+
+        std::size_t linesCount = 0;
+        for (const ParsedFile& pf : parsed) linesCount += pf.lines.size();
+        std::size_t capacity = 2;
+        while (capacity < 2 * linesCount) capacity <<= 1;
+
+        //Open addressing over candidate indices, slot holds index + 1 (0 - empty)
+        std::vector<std::size_t> slots(capacity, 0);
+        std::vector<std::size_t> hashes;
+        std::vector<Candidate> candidates;
+        for (std::size_t f = 0; f < parsed.size(); f++)
+        {
+            const ParsedFile& pf = parsed[f];
+            std::string tag;
+            for (const ParsedLine& line : pf.lines)
+            {
+                const unsigned long* gaps = pf.gaps.data() + line.gapsBegin;
+                std::size_t slot = line.hash & (capacity - 1);
+                bool duplicate = false;
+                for (; slots[slot] != 0 && !duplicate; slot = (slot + 1) & (capacity - 1))
                 {
-                    if (gap.empty() || gap.find_first_not_of(" \t\r\n") == std::string::npos) { continue; }
-
-                    try 
-                    {
-                        gaps.push_back(std::stoul(gap));
-                    } 
-                    catch (const std::invalid_argument& e) 
-                    {
-                        printf("WARNING: Invalid gap value '%s' in file '%s'. Skipping this gap.\n", gap.c_str(), path.c_str());
-                        continue;
-                    }
+                    std::size_t c = slots[slot] - 1;
+                    const Candidate& other = candidates[c];
+                    duplicate = hashes[c] == line.hash && other.sortingRange == pf.sortingRange && other.gapSequence.gaps.size() == line.gapsCount
+                        && std::equal(gaps, gaps + line.gapsCount, other.gapSequence.gaps.begin());
                 }
+                if (duplicate) continue;
 
-                gapsFromFile.push_back(GapSequence(sequenceName, gaps));
+                if (tag.empty()) tag = ParseFileName(textFiles[f]).second;
+                slots[slot] = candidates.size() + 1;
+                hashes.push_back(line.hash);
+                Candidate& candidate = candidates.emplace_back();
+                candidate.sortingRange = pf.sortingRange;
+                candidate.tag = tag;
+                candidate.gapSequence.name.assign(line.name);
+                candidate.gapSequence.gaps.assign(gaps, gaps + line.gapsCount);
             }
         }
 
-        return gapsFromFile;
+        return candidates;
+    }
+
+    // Unique sequences found for a sorting range, e.g. to seed a search or re-evaluate old results
+    std::vector<GapSequence> GetCandidateGapSequences(unsigned long sortingRange, const std::vector<std::string>& paths = { "Results" })
+    {
+        std::vector<GapSequence> sequences;
+        for (Candidate& candidate : LoadCandidates(paths))
+        {
+            if (candidate.sortingRange == sortingRange) sequences.push_back(std::move(candidate.gapSequence));
+        }
+        return sequences;
+    }
+
+    // Template instantiation for a given sequence, e.g. "Shellsort<701, 301, 132, 57, 23, 10, 4, 1>"
+    std::string GetFixedGapsKernel(const GapSequence& sequence)
+    {
+        std::string kernel = "Shellsort<";
+        for (std::size_t i = 0; i < sequence.gaps.size(); ++i)
+        {
+            if (i > 0) kernel += ", ";
+            kernel += std::to_string(sequence.gaps[i]) + "UL";
+        }
+        return kernel + ">";
+    }
+
+    // Contents of a C++ string literal - quotes, backslashes and control characters escaped
+    std::string GetEscapedStringLiteral(const std::string& text)
+    {
+        std::string escaped;
+        for (unsigned char c : text)
+        {
+            if (c == '"' || c == '\\') { escaped += '\\'; escaped += c; }
+            else if (c < 0x20 || c == 0x7F)
+            {
+                const char* digits = "01234567";
+                escaped += '\\';
+                escaped += digits[(c >> 6) & 7];
+                escaped += digits[(c >> 3) & 7];
+                escaped += digits[c & 7];
+            }
+            else escaped += c;
+        }
+        return escaped;
+    }
+
+    // Turns every line of a candidates file into compile-time kernel, header is saved to Results/Kernels
+    void SaveFixedGapsKernelsToFile(std::string fileName)
+    {
+        std::vector<GapSequence> sequences = GetGapsFromFile(fileName);
+        if (sequences.empty())
+        {
+            std::cerr << "ERROR: No gap sequences found in: Results/" << fileName << std::endl;
+            return;
+        }
+
+        std::string baseName = std::filesystem::path(fileName).stem().string();
+        std::filesystem::create_directories("Results/Kernels");
+        std::string filename = "Results/Kernels/" + baseName + "_Kernels.hpp";
+        std::ofstream file(filename, std::ios::trunc);
+
+        if (!file.is_open())
+        {
+            std::cerr << "ERROR: Could not open file for writing: " << filename << std::endl;
+            return;
+        }
+
+        std::string guard = baseName;
+        std::transform(guard.begin(), guard.end(), guard.begin(), [](unsigned char c) { return std::isalnum(c) ? std::toupper(c) : '_'; });
+
+        file << "// Generated from Results/" << fileName << "\n";
+        file << "#ifndef " << guard << "_KERNELS_HPP\n#define " << guard << "_KERNELS_HPP\n\n";
+        file << "#include <utility>\n#include <vector>\n#include \"../../Components/Shellsort.hpp\"\n\n";
+        file << "namespace kernels_" << guard << "\n{\n";
+        file << "    const std::vector<std::pair<GapSequence, FixedShellsortKernel>> kernels =\n    {\n";
+        for (const GapSequence& sequence : sequences)
+        {
+            if (sequence.gaps.empty()) continue;
+
+            std::string gapsList;
+            for (std::size_t i = 0; i < sequence.gaps.size(); ++i) gapsList += (i > 0 ? ", " : "") + std::to_string(sequence.gaps[i]);
+
+            file << "        { GapSequence(\"" << GetEscapedStringLiteral(sequence.name) << "\", { " << gapsList << " }), &" << GetFixedGapsKernel(sequence) << " },\n";
+        }
+        file << "    };\n}\n\n#endif\n";
+        file.flush();
+        file.close();
+
+        std::cout << "Saved to: " << filename << std::endl;
     }
 }
 
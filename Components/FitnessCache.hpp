@@ -0,0 +1,383 @@
+#ifndef FITNESS_CACHE_HPP
+#define FITNESS_CACHE_HPP
+
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <mutex>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <omp.h>
+#include "Shellsort.hpp"
+#include "ShellsortComparisons.hpp"
+#include "GapPrefixTrie.hpp"
+#include "TimingHarness.hpp"
+#include "Utilis.hpp"
+
+// Welford running mean and variance
+struct RunningStats
+{
+    long samples = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+
+    void Add(double value)
+    {
+        samples++;
+        double delta = value - mean;
+        mean += delta / samples;
+        m2 += delta * (value - mean);
+    }
+
+    double GetVariance() const
+    {
+        return samples > 1 ? m2 / (samples - 1) : 0.0;
+    }
+
+    double GetStdDev() const
+    {
+        return std::sqrt(GetVariance());
+    }
+};
+
+struct CachedFitness
+{
+    RunningStats time;
+    RunningStats comparisons;
+    RunningStats loops;
+    RunningStats operations;
+    RunningStats moves;
+    RunningStats cycles;
+    RunningStats instructions;
+    RunningStats branchMisses;
+    RunningStats l1Misses;
+    RunningStats llcMisses;
+    RunningStats tlbMisses;
+
+    void Add(const Result& sample)
+    {
+        time.Add(sample.time);
+        comparisons.Add(sample.comparisons);
+        loops.Add(sample.loops);
+        operations.Add(sample.operations);
+        moves.Add(sample.moves);
+        cycles.Add(sample.cycles);
+        instructions.Add(sample.instructions);
+        branchMisses.Add(sample.branchMisses);
+        l1Misses.Add(sample.l1Misses);
+        llcMisses.Add(sample.llcMisses);
+        tlbMisses.Add(sample.tlbMisses);
+    }
+
+    long GetSamples() const { return operations.samples; }
+
+    // Result with means of all samples collected so far
+    Result ToResult(const GapSequence& gapSequence) const
+    {
+        Result r;
+        r.time = time.mean;
+        r.comparisons = comparisons.mean;
+        r.loops = loops.mean;
+        r.operations = operations.mean;
+        r.moves = moves.mean;
+        r.cycles = cycles.mean;
+        r.instructions = instructions.mean;
+        r.branchMisses = branchMisses.mean;
+        r.l1Misses = l1Misses.mean;
+        r.llcMisses = llcMisses.mean;
+        r.tlbMisses = tlbMisses.mean;
+        r.gapSequence = gapSequence;
+        r.samples = GetSamples();
+        return r;
+    }
+};
+
+// Thread-safe fitness statistics keyed by (sortingRange, gaps), sharded to keep lock contention low.
+// At most capacity entries are kept, least recently used ones are evicted in batches
+class FitnessCache
+{
+    public:
+    // Sequences with at least this many samples are not measured again (0 - always measured)
+    long sampleLimit = 0;
+    // Entries kept across all shards (0 - unlimited)
+    std::size_t capacity = 0;
+
+    FitnessCache(long sampleLimit = 0, std::size_t capacity = 0) : sampleLimit(sampleLimit), capacity(capacity) {}
+
+    void AddSample(unsigned long sortingRange, const std::vector<unsigned long>& gaps, const Result& sample)
+    {
+        Shard& shard = GetShard(sortingRange, gaps);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry& entry = shard.entries[Key{ sortingRange, gaps }];
+        entry.fitness.Add(sample);
+        entry.lastUse = ++shard.clock;
+        EvictIfFull(shard);
+    }
+
+    bool Get(unsigned long sortingRange, const std::vector<unsigned long>& gaps, CachedFitness& fitness) const
+    {
+        const Shard& shard = GetShard(sortingRange, gaps);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(Key{ sortingRange, gaps });
+        if (it == shard.entries.end()) return false;
+        fitness = it->second.fitness;
+        it->second.lastUse = ++shard.clock;
+        return true;
+    }
+
+    long GetSamples(unsigned long sortingRange, const std::vector<unsigned long>& gaps) const
+    {
+        CachedFitness fitness;
+        return Get(sortingRange, gaps, fitness) ? fitness.GetSamples() : 0;
+    }
+
+    bool IsSettled(unsigned long sortingRange, const std::vector<unsigned long>& gaps) const
+    {
+        return sampleLimit > 0 && GetSamples(sortingRange, gaps) >= sampleLimit;
+    }
+
+    // Replaces statistics of the key, used when restoring from checkpoint
+    void SetEntry(unsigned long sortingRange, const std::vector<unsigned long>& gaps, const CachedFitness& fitness)
+    {
+        Shard& shard = GetShard(sortingRange, gaps);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry& entry = shard.entries[Key{ sortingRange, gaps }];
+        entry.fitness = fitness;
+        entry.lastUse = ++shard.clock;
+        EvictIfFull(shard);
+    }
+
+    // Visits every entry as (sortingRange, gaps, fitness), each shard under its lock
+    template <typename Visitor>
+    void ForEachEntry(Visitor visit) const
+    {
+        for (const Shard& shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& entry : shard.entries) visit(entry.first.sortingRange, entry.first.gaps, entry.second.fitness);
+        }
+    }
+
+    std::size_t Size() const
+    {
+        std::size_t size = 0;
+        for (const Shard& shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            size += shard.entries.size();
+        }
+        return size;
+    }
+
+    private:
+    struct Key
+    {
+        unsigned long sortingRange;
+        std::vector<unsigned long> gaps;
+
+        bool operator==(const Key& other) const { return sortingRange == other.sortingRange && gaps == other.gaps; }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const
+        {
+            return GapSequenceHash::HashGaps(key.gaps) ^ (key.sortingRange * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    struct Entry
+    {
+        CachedFitness fitness;
+        mutable std::uint64_t lastUse = 0;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        mutable std::uint64_t clock = 0;
+        std::unordered_map<Key, Entry, KeyHash> entries;
+    };
+
+    static const std::size_t SHARDS_COUNT = 64;
+    std::array<Shard, SHARDS_COUNT> shards;
+
+    // Over its share of the capacity a shard drops its least recently used quarter, so eviction is amortized O(1)
+    void EvictIfFull(Shard& shard)
+    {
+        if (capacity == 0) return;
+        const std::size_t shardCapacity = std::max<std::size_t>(1, capacity / SHARDS_COUNT);
+        if (shard.entries.size() <= shardCapacity) return;
+
+        std::vector<std::uint64_t> uses;
+        uses.reserve(shard.entries.size());
+        for (const auto& entry : shard.entries) uses.push_back(entry.second.lastUse);
+        const std::size_t evicted = shard.entries.size() - shardCapacity + shardCapacity / 4;
+        std::nth_element(uses.begin(), uses.begin() + (evicted - 1), uses.end());
+        const std::uint64_t threshold = uses[evicted - 1];
+
+        for (auto it = shard.entries.begin(); it != shard.entries.end();)
+        {
+            if (it->second.lastUse <= threshold) it = shard.entries.erase(it);
+            else ++it;
+        }
+    }
+
+    Shard& GetShard(unsigned long sortingRange, const std::vector<unsigned long>& gaps)
+    {
+        return shards[KeyHash()(Key{ sortingRange, gaps }) % SHARDS_COUNT];
+    }
+
+    const Shard& GetShard(unsigned long sortingRange, const std::vector<unsigned long>& gaps) const
+    {
+        return shards[KeyHash()(Key{ sortingRange, gaps }) % SHARDS_COUNT];
+    }
+};
+
+// Shared by all search algorithms, Ciura/SEJ in "Checking for new best" stop being measured once settled.
+// Endless searches meet new sequences every generation, 100000 entries keep memory and checkpoints bounded
+FitnessCache sharedFitnessCache(1000, 100000);
+
+// CompareShellsorts where every measurement is added to the cache and results are means over all cached samples,
+// settled sequences are not measured again and do not take part in wins counting - a cached mean is not
+// comparable to a single dataset's value.
+// With common random numbers the k-th sample of every sequence is taken on the k-th dataset, so repeated
+// sequences get new datasets while sequences with equal sample counts stay paired.
+// With budgetFactor > 0 (measured without prefix trie) sorts are aborted past budgetFactor times the cached mean
+// operations of gapSequences[0], censored sequences are not cached, not measured again and ranked last.
+// When the searches time in isolation (timing::IsSearchTimingIsolated) the population goes to CompareShellsorts_Timed
+// instead, contended times of the cache would not be comparable to isolated ones
+std::vector<Result> CompareShellsorts(unsigned long sortingRange, std::vector<GapSequence> gapSequences, int iterations, FitnessCache& cache, bool usePrefixTrie = false, double budgetFactor = 0.0)
+{
+    if (timing::IsSearchTimingIsolated()) return CompareShellsorts_Timed(sortingRange, gapSequences, iterations);
+
+    struct MeasuredGroup
+    {
+        long priorSamples = 0;
+        std::vector<GapSequence> sequences;
+        std::vector<Result> censoredResults;
+        GapPrefixTrie trie = GapPrefixTrie({});
+    };
+
+    int sortsCount = gapSequences.size();
+    std::vector<Result> avgResults(sortsCount);
+    std::vector<Result> settledResults(sortsCount);
+
+    //Unique unsettled sequences grouped by samples already in the cache
+    std::vector<MeasuredGroup> groups;
+    std::unordered_map<GapSequence, std::pair<int, int>, GapSequenceHash> measuredPositions;
+    for (int j = 0; j < sortsCount; j++)
+    {
+        avgResults[j].gapSequence = gapSequences[j];
+        settledResults[j].gapSequence = gapSequences[j];
+
+        CachedFitness fitness;
+        bool cached = cache.Get(sortingRange, gapSequences[j].gaps, fitness);
+        if (cached) settledResults[j] = fitness.ToResult(gapSequences[j]);
+        if (cache.IsSettled(sortingRange, gapSequences[j].gaps) || measuredPositions.count(gapSequences[j]) > 0) continue;
+
+        long priorSamples = (utilis::commonRandomNumbers && cached) ? fitness.GetSamples() : 0;
+        auto group = std::find_if(groups.begin(), groups.end(), [&](const MeasuredGroup& g) { return g.priorSamples == priorSamples; });
+        if (group == groups.end())
+        {
+            groups.push_back(MeasuredGroup());
+            groups.back().priorSamples = priorSamples;
+            group = groups.end() - 1;
+        }
+        measuredPositions[gapSequences[j]] = { static_cast<int>(group - groups.begin()), static_cast<int>(group->sequences.size()) };
+        group->sequences.push_back(gapSequences[j]);
+    }
+
+    if (usePrefixTrie)
+    {
+        for (MeasuredGroup& group : groups) group.trie = GapPrefixTrie(group.sequences);
+    }
+
+    ShellsortBudget budget;
+    if (budgetFactor > 0.0 && !usePrefixTrie && sortsCount > 0)
+    {
+        budget.operations = static_cast<unsigned long>(budgetFactor * settledResults[0].operations);
+    }
+    for (MeasuredGroup& group : groups) group.censoredResults.resize(group.sequences.size());
+
+    for (int i = 0; i < iterations && !groups.empty(); i++)
+    {
+        std::vector<std::vector<Result>> groupResults(groups.size());
+        for (std::size_t g = 0; g < groups.size(); g++)
+        {
+            const MeasuredGroup& group = groups[g];
+
+            // Get random data for sorting
+            std::vector<int> data = utilis::GetSortingDataForIteration(sortingRange, group.priorSamples + i);
+
+            if (usePrefixTrie)
+            {
+                groupResults[g] = group.trie.EvaluateDataset(data);
+                continue;
+            }
+
+            groupResults[g].resize(group.sequences.size());
+            #pragma omp parallel for
+            for (int m = 0; m < static_cast<int>(group.sequences.size()); m++)
+            {
+                if (group.censoredResults[m].censored > 0) continue;
+                groupResults[g][m] = budget.operations > 0 ? MeasureShellsort_Full(data, group.sequences[m], budget) : MeasureShellsort_Full(data, group.sequences[m]);
+            }
+        }
+
+        for (std::size_t g = 0; g < groups.size(); g++)
+        {
+            for (std::size_t m = 0; m < groups[g].sequences.size(); m++)
+            {
+                if (groups[g].censoredResults[m].censored > 0) continue;
+                if (groupResults[g][m].censored > 0) { groups[g].censoredResults[m] = groupResults[g][m]; continue; }
+                cache.AddSample(sortingRange, groups[g].sequences[m].gaps, groupResults[g][m]);
+            }
+        }
+
+        // Getting best result of every group for wins count (groups sort different datasets with common random numbers),
+        // settled and censored results can not win
+        for (std::size_t g = 0; g < groups.size(); g++)
+        {
+            int winner = -1;
+            for (int m = 0; m < static_cast<int>(groups[g].sequences.size()); m++)
+            {
+                if (groups[g].censoredResults[m].censored > 0) continue;
+                if (winner < 0 || groupResults[g][m].GetFitnessScore() < groupResults[g][winner].GetFitnessScore()) winner = m;
+            }
+
+            if (winner >= 0) for (Result& r : avgResults) if (r.gapSequence == groups[g].sequences[winner]) { r.wins++; }
+        }
+    }
+
+    // Means over every sample in the cache, including earlier generations, censored ones keep their lower bound
+    for (Result& r : avgResults)
+    {
+        int wins = r.wins;
+        auto position = measuredPositions.find(r.gapSequence);
+        CachedFitness fitness;
+        if (position != measuredPositions.end() && groups[position->second.first].censoredResults[position->second.second].censored > 0)
+        {
+            r = groups[position->second.first].censoredResults[position->second.second];
+        }
+        else if (cache.Get(sortingRange, r.gapSequence.gaps, fitness))
+        {
+            r = fitness.ToResult(r.gapSequence);
+        }
+        r.wins = wins;
+    }
+
+    // Sort results return order by fitness score, censored after fully measured
+    std::sort(avgResults.begin(), avgResults.end(), [](const Result& a, const Result& b) {
+        if ((a.censored > 0) != (b.censored > 0)) return a.censored == 0;
+        return a.GetFitnessScore() < b.GetFitnessScore();
+        });
+
+    return avgResults;
+}
+
+
+#endif // !FITNESS_CACHE_HPP
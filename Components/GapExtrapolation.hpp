@@ -0,0 +1,169 @@
+#ifndef GAP_EXTRAPOLATION_HPP
+#define GAP_EXTRAPOLATION_HPP
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <omp.h>
+#include "Shellsort.hpp"
+#include "ShellsortComparisons.hpp"
+#include "Utilis.hpp"
+
+// Gap sequences for any n up to 2^63 - geometric recurrences in 128-bit fixed point instead of std::pow doubles,
+// and extension of found sequences by their fitted growth ratio
+namespace extrapolation
+{
+    // Unsigned fixed point with 60 fractional bits, integer part below 2^68, ratios below 16
+    using Fixed = unsigned __int128;
+    const int FRACTION_BITS = 60;
+    const std::uint64_t MAX_RANGE = 1ULL << 63;
+
+    Fixed ToFixed(long double value)
+    {
+        return static_cast<Fixed>(std::ldexp(value, FRACTION_BITS));
+    }
+
+    // Integer parts stay in Fixed - past 2^63 they no longer fit an unsigned long
+    Fixed Floor(Fixed value) { return value >> FRACTION_BITS; }
+
+    Fixed Ceil(Fixed value) { return Floor(value + ((Fixed(1) << FRACTION_BITS) - 1)); }
+
+    // value * ratio without overflow while value < 2^124 and ratio < 16 (value split into 64-bit halves)
+    Fixed Multiply(Fixed value, Fixed ratio)
+    {
+        Fixed high = value >> 64;
+        Fixed low = value & 0xFFFFFFFFFFFFFFFFULL;
+        return ((high * ratio) << (64 - FRACTION_BITS)) + ((low * ratio) >> FRACTION_BITS);
+    }
+
+    // value_k = value_{k-1} * ratio + increment from value_0 = start, rounded gaps below sortingRange in decreasing order.
+    // Gaps are kept strictly increasing even where rounding would repeat one
+    std::vector<unsigned long> GetRecurrenceGaps(unsigned long sortingRange, Fixed start, Fixed ratio, Fixed increment, bool roundUp)
+    {
+        std::vector<unsigned long> gaps;
+        if (start == 0 && increment == 0) return gaps; //would stay at 0 forever
+        const Fixed limit = std::min<std::uint64_t>(sortingRange, MAX_RANGE);
+        for (Fixed value = start; Floor(value) < limit; value = Multiply(value, ratio) + increment)
+        {
+            Fixed gap = roundUp ? Ceil(value) : Floor(value);
+            if (!gaps.empty() && gap <= gaps.back()) gap = gaps.back() + 1;
+            if (gap == 0) continue;
+            if (gap >= limit) break;
+            gaps.push_back(static_cast<unsigned long>(gap));
+        }
+        std::reverse(gaps.begin(), gaps.end());
+        return gaps;
+    }
+
+    // Tokuda 1992: h_k = ceil(h'_k), h'_k = 9/4 h'_{k-1} + 1, h'_1 = 1
+    GapSequence GetTokudaGaps(unsigned long sortingRange)
+    {
+        return GapSequence("Tokuda", GetRecurrenceGaps(sortingRange, ToFixed(1.0L), ToFixed(2.25L), ToFixed(1.0L), true));
+    }
+
+    // Lee 2021: h_k = ceil(h'_k), h'_k = lambda h'_{k-1} + 1, h'_1 = 1
+    GapSequence GetLeeGaps(unsigned long sortingRange)
+    {
+        return GapSequence("Lee", GetRecurrenceGaps(sortingRange, ToFixed(1.0L), ToFixed(2.24360906142L), ToFixed(1.0L), true));
+    }
+
+    // Skean, Ehrenborg, Jaromczyk 2023: h_k = floor(4.0816 * 8.5714^(k / 2.2449)), k >= -1
+    GapSequence GetSkeanEhrenborgJaromczykGaps(unsigned long sortingRange)
+    {
+        const long double ratio = std::pow(8.5714L, 1.0L / 2.2449L);
+        return GapSequence("SEJ", GetRecurrenceGaps(sortingRange, ToFixed(4.0816L / ratio), ToFixed(ratio), 0, false));
+    }
+
+    // Ciura 2001 continued past 1750 by the customary h_k = floor(2.25 h_{k-1})
+    GapSequence GetCiuraExtendedGaps(unsigned long sortingRange)
+    {
+        GapSequence ciura = ::GetCiuraGaps(sortingRange);
+        if (ciura.gaps.empty() || ciura.gaps.front() != 1750) return GapSequence("Ciura_Extended", ciura.gaps);
+
+        std::vector<unsigned long> extension = GetRecurrenceGaps(sortingRange, ToFixed(1750.0L), ToFixed(2.25L), 0, false);
+        extension.pop_back(); //1750 itself
+        extension.insert(extension.end(), ciura.gaps.begin(), ciura.gaps.end());
+        return GapSequence("Ciura_Extended", extension);
+    }
+
+    // Growth ratio by least squares of ln(gap) over gap index, on the fitGaps largest gaps - small gaps are irregular
+    double FitGrowthRatio(const std::vector<unsigned long>& gaps, std::size_t fitGaps = 4)
+    {
+        std::vector<unsigned long> ascending(gaps.rbegin(), gaps.rend());
+        std::size_t count = std::min(fitGaps, ascending.size());
+        if (count < 2) return 2.25;
+
+        double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+        for (std::size_t i = ascending.size() - count; i < ascending.size(); i++)
+        {
+            double x = static_cast<double>(i), y = std::log(static_cast<double>(ascending[i]));
+            sumX += x; sumY += y; sumXX += x * x; sumXY += x * y;
+        }
+        double slope = (count * sumXY - sumX * sumY) / (count * sumXX - sumX * sumX);
+        return std::clamp(std::exp(slope), 1.1, 15.0);
+    }
+
+    // Found sequence continued above its largest gap by the fitted growth ratio up to sortingRange (at most 2^63),
+    // gaps of the found sequence not below sortingRange are dropped, as are 0 gaps. No gaps left - empty sequence
+    GapSequence ExtendGapSequence(const GapSequence& found, unsigned long sortingRange, std::size_t fitGaps = 4)
+    {
+        std::vector<unsigned long> gaps = found.gaps;
+        gaps.erase(std::remove(gaps.begin(), gaps.end(), 0UL), gaps.end());
+        std::sort(gaps.begin(), gaps.end(), std::greater<unsigned long>());
+        gaps.erase(std::unique(gaps.begin(), gaps.end()), gaps.end());
+
+        GapSequence extended(found.name + "|Extended", {});
+        if (gaps.empty()) return extended;
+
+        double ratio = FitGrowthRatio(gaps, fitGaps);
+        std::vector<unsigned long> extension = GetRecurrenceGaps(sortingRange, ToFixed(gaps.front()), ToFixed(ratio), 0, false);
+        if (!extension.empty()) extension.pop_back(); //the largest found gap itself
+
+        for (unsigned long gap : gaps) if (gap < sortingRange) extension.push_back(gap);
+        extended.gaps = extension;
+        return extended;
+    }
+
+    // Extended sequence against the exact baselines at the target size, ranked by fitness. Every thread of CompareShellsorts
+    // sorts its own copy of the dataset (two with hardware counters), so threads are limited to the copies fitting
+    // memoryBudget next to the dataset, as in scaling::RunScalingSweep
+    std::vector<Result> CheckExtendedSequence(const GapSequence& found, unsigned long sortingRange, int iterations, std::size_t fitGaps = 4, std::size_t memoryBudget = 2ULL << 30)
+    {
+        GapSequence extended = ExtendGapSequence(found, sortingRange, fitGaps);
+        if (extended.gaps.empty())
+        {
+            std::cerr << "ERROR: " << found.name << " has no gaps to extend" << std::endl;
+            return {};
+        }
+
+        const std::size_t copiesPerThread = perf_counters::enabled ? 2 : 1;
+        const std::size_t copies = utilis::GetConcurrentCopies(static_cast<std::size_t>(sortingRange) * sizeof(int), memoryBudget);
+        if (copies < copiesPerThread)
+        {
+            std::cerr << "ERROR: n = " << sortingRange << " does not fit the memory budget of " << memoryBudget << " bytes" << std::endl;
+            return {};
+        }
+
+        std::vector<GapSequence> group =
+        {
+            extended,
+            GetTokudaGaps(sortingRange),
+            GetCiuraExtendedGaps(sortingRange),
+            GetLeeGaps(sortingRange),
+            GetSkeanEhrenborgJaromczykGaps(sortingRange)
+        };
+
+        const int threads = omp_get_max_threads();
+        omp_set_num_threads(static_cast<int>(std::min<std::size_t>(threads, copies / copiesPerThread)));
+        std::vector<Result> results = CompareShellsorts(sortingRange, group, iterations);
+        omp_set_num_threads(threads);
+        return results;
+    }
+}
+
+
+#endif // !GAP_EXTRAPOLATION_HPP
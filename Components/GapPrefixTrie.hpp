@@ -0,0 +1,235 @@
+#ifndef GAP_PREFIX_TRIE_HPP
+#define GAP_PREFIX_TRIE_HPP
+
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <omp.h>
+#include "Shellsort.hpp"
+#include "ShellsortComparisons.hpp"
+#include "Utilis.hpp"
+
+// Trie of gap prefixes over a population - every shared prefix is run once per dataset and the partially
+// sorted array is copied only where sequences branch
+class GapPrefixTrie
+{
+    public:
+    struct Node
+    {
+        unsigned long gap = 0;
+        std::vector<int> children;
+        std::vector<int> sequences;
+    };
+
+    struct EdgeStats
+    {
+        double time = 0.0;
+        OperationCounters counter;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<GapSequence> gapSequences;
+
+    GapPrefixTrie(const std::vector<GapSequence>& gapSequences) :
+        nodes(1),
+        gapSequences(gapSequences)
+    {
+        for (std::size_t s = 0; s < gapSequences.size(); s++)
+        {
+            int nodeIndex = 0;
+            for (unsigned long gap : gapSequences[s].gaps)
+            {
+                nodeIndex = GetOrAddChild(nodeIndex, gap);
+            }
+            nodes[nodeIndex].sequences.push_back(static_cast<int>(s));
+        }
+    }
+
+    // Number of h-sorting passes run per dataset by the trie compared to running every sequence separately
+    std::size_t GetEdgesCount() const { return nodes.size() - 1; }
+
+    std::size_t GetPassesCount() const
+    {
+        std::size_t passes = 0;
+        for (const GapSequence& gs : gapSequences) passes += gs.gaps.size();
+        return passes;
+    }
+
+    // Results for every sequence (in construction order) on a single dataset
+    std::vector<Result> EvaluateDataset(const std::vector<int>& data) const
+    {
+        std::vector<EdgeStats> edgeStats(nodes.size());
+
+        //Every branch of the trie is a task, so a population sharing its first gaps still runs on all threads
+        #pragma omp parallel
+        #pragma omp single
+        {
+            std::vector<int> arr = data;
+            EvaluateSubtree(0, arr, edgeStats);
+        }
+
+        std::vector<Result> results(gapSequences.size());
+        std::vector<EdgeStats> path;
+        CollectResults(0, path, edgeStats, results);
+
+        //Hardware counters of a shared prefix do not split between sequences, every sequence is sorted on its own
+        if (perf_counters::enabled)
+        {
+            #pragma omp parallel for schedule(dynamic, 1)
+            for (int s = 0; s < static_cast<int>(gapSequences.size()); s++)
+            {
+                results[s].AddHardwareCounters(MeasureShellsort_Hardware(data, gapSequences[s]));
+            }
+        }
+        return results;
+    }
+
+    private:
+    int GetOrAddChild(int nodeIndex, unsigned long gap)
+    {
+        for (int child : nodes[nodeIndex].children)
+        {
+            if (nodes[child].gap == gap) return child;
+        }
+
+        Node child;
+        child.gap = gap;
+        nodes.push_back(child);
+        nodes[nodeIndex].children.push_back(static_cast<int>(nodes.size() - 1));
+        return static_cast<int>(nodes.size() - 1);
+    }
+
+    void RunEdge(int nodeIndex, std::vector<int>& arr, std::vector<EdgeStats>& edgeStats) const
+    {
+        std::less<> comp;
+        IdentityProjection proj;
+        EdgeStats& stats = edgeStats[nodeIndex];
+
+        auto start = std::chrono::high_resolution_clock::now();
+        HSortPass(arr.begin(), arr.end(), nodes[nodeIndex].gap, comp, proj, stats.counter);
+        auto stop = std::chrono::high_resolution_clock::now();
+
+        stats.time = std::chrono::duration<double, std::milli>(stop - start).count();
+    }
+
+    void EvaluateSubtree(int nodeIndex, std::vector<int>& arr, std::vector<EdgeStats>& edgeStats) const
+    {
+        const std::vector<int>& children = nodes[nodeIndex].children;
+        for (std::size_t c = 0; c < children.size(); c++)
+        {
+            //Last child continues on the current array, others branch from a snapshot
+            if (c + 1 == children.size())
+            {
+                RunEdge(children[c], arr, edgeStats);
+                EvaluateSubtree(children[c], arr, edgeStats);
+            }
+            else
+            {
+                auto snapshot = std::make_shared<std::vector<int>>(arr);
+                const int child = children[c];
+                #pragma omp task firstprivate(snapshot, child) shared(edgeStats)
+                {
+                    RunEdge(child, *snapshot, edgeStats);
+                    EvaluateSubtree(child, *snapshot, edgeStats);
+                }
+            }
+        }
+    }
+
+    void CollectResults(int nodeIndex, std::vector<EdgeStats>& path, const std::vector<EdgeStats>& edgeStats, std::vector<Result>& results) const
+    {
+        for (int s : nodes[nodeIndex].sequences)
+        {
+            Result r;
+            OperationCounters total;
+            for (const EdgeStats& edge : path)
+            {
+                r.time += edge.time;
+                total.comparisons += edge.counter.comparisons;
+                total.loops += edge.counter.loops;
+                total.moves += edge.counter.moves;
+                total.operations += edge.counter.operations;
+            }
+            r.comparisons = static_cast<double>(total.comparisons);
+            r.loops = static_cast<double>(total.loops);
+            r.operations = static_cast<double>(total.GetOperations());
+            r.moves = static_cast<double>(total.moves);
+            r.gapSequence = gapSequences[s];
+            results[s] = r;
+        }
+
+        for (int child : nodes[nodeIndex].children)
+        {
+            path.push_back(edgeStats[child]);
+            CollectResults(child, path, edgeStats, results);
+            path.pop_back();
+        }
+    }
+};
+
+// Same contract as CompareShellsorts, but the population is evaluated through the gap prefix trie
+std::vector<Result> CompareShellsorts_Trie(unsigned long sortingRange, std::vector<GapSequence> gapSequences, int iterations)
+{
+    int sortsCount = gapSequences.size();
+    std::vector<Result> avgResults(sortsCount);
+    GapPrefixTrie trie(gapSequences);
+
+    for (int i = 0; i < iterations; i++)
+    {
+        // Get random data for sorting
+        std::vector<int> data = utilis::GetSortingDataForIteration(sortingRange, i);
+
+        std::vector<Result> results = trie.EvaluateDataset(data);
+
+        // Accumulate results for averaging
+        for (int j = 0; j < sortsCount; j++)
+        {
+            if (i == 0)
+            {
+                avgResults[j] = results[j];
+                continue;
+            }
+            avgResults[j].time += results[j].time;
+            avgResults[j].comparisons += results[j].comparisons;
+            avgResults[j].loops += results[j].loops;
+            avgResults[j].operations += results[j].operations;
+            avgResults[j].moves += results[j].moves;
+            avgResults[j].AddHardwareCounters(results[j]);
+        }
+
+        // Getting best result for wins count
+        auto winner_it = std::min_element(results.begin(), results.end(),
+            [](const Result& a, const Result& b) {
+                return a.GetFitnessScore() < b.GetFitnessScore();
+            }
+        );
+        Result winner = *winner_it;
+
+        for (Result& r : avgResults) if (r.gapSequence == winner.gapSequence) { r.wins++; }
+    }
+
+    // Average the results over the number of iterations
+    for (Result& r : avgResults)
+    {
+        r.time = r.time / iterations;
+        r.comparisons = r.comparisons / iterations;
+        r.loops = r.loops / iterations;
+        r.operations = r.operations / iterations;
+        r.moves = r.moves / iterations;
+        r.DivideHardwareCounters(iterations);
+        r.samples = iterations;
+    }
+
+    // Sort results return order by fitness score
+    std::sort(avgResults.begin(), avgResults.end(), [](const Result& a, const Result& b) {
+        return a.GetFitnessScore() < b.GetFitnessScore();
+        });
+
+    return avgResults;
+}
+
+
+#endif // !GAP_PREFIX_TRIE_HPP
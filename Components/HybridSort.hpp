@@ -0,0 +1,219 @@
+#ifndef HYBRID_SORT_HPP
+#define HYBRID_SORT_HPP
+
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <algorithm>
+#include "Shellsort.hpp"
+#include "ShellsortComparisons.hpp"
+#include "InputDistributions.hpp"
+#include "FilesManagement.hpp"
+#include "Utilis.hpp"
+
+// Introsort-like hybrid - quicksort partitioning down to blockSize, every block finished by Shellsort with gaps
+// tuned for that size, heapsort once the recursion gets too deep keeps the worst case at O(n log n)
+namespace hybrid
+{
+    // Partitions of at most blockSize elements are left to Shellsort
+    std::size_t blockSize = 1000;
+    // Gaps for blocks, Ciura unless replaced by the best candidate of Results (GetBestBlockGaps)
+    std::vector<unsigned long> blockGaps = { 701, 301, 132, 57, 23, 10, 4, 1 };
+
+    template <typename RandomIt, typename Compare>
+    void MoveMedianToFirst(RandomIt result, RandomIt a, RandomIt b, RandomIt c, Compare& comp)
+    {
+        if (comp(*a, *b))
+        {
+            if (comp(*b, *c)) std::iter_swap(result, b);
+            else if (comp(*a, *c)) std::iter_swap(result, c);
+            else std::iter_swap(result, a);
+        }
+        else if (comp(*a, *c)) std::iter_swap(result, a);
+        else if (comp(*b, *c)) std::iter_swap(result, c);
+        else std::iter_swap(result, b);
+    }
+
+    // Hoare partition around the median of three, moved to *first. Both scans stop on keys equal to the pivot,
+    // so few unique keys still split evenly. Requires at least 4 elements
+    template <typename RandomIt, typename Compare>
+    RandomIt Partition(RandomIt first, RandomIt last, Compare& comp)
+    {
+        MoveMedianToFirst(first, first + 1, first + (last - first) / 2, last - 1, comp);
+        RandomIt left = first + 1, right = last;
+        while (true)
+        {
+            while (comp(*left, *first)) ++left;
+            --right;
+            while (comp(*first, *right)) --right;
+            if (!(left < right)) return left;
+            std::iter_swap(left, right);
+            ++left;
+        }
+    }
+
+    // Smaller side recursed, larger side looped - stack depth stays O(log n)
+    template <typename RandomIt, typename Compare>
+    void HybridSortLoop(RandomIt first, RandomIt last, int depthLimit, Compare& comp, std::size_t maxBlock, const std::vector<unsigned long>& gaps)
+    {
+        while (static_cast<std::size_t>(last - first) > maxBlock)
+        {
+            if (depthLimit-- == 0)
+            {
+                std::make_heap(first, last, comp);
+                std::sort_heap(first, last, comp);
+                return;
+            }
+            RandomIt cut = Partition(first, last, comp);
+            if (cut - first < last - cut)
+            {
+                HybridSortLoop(first, cut, depthLimit, comp, maxBlock, gaps);
+                first = cut;
+            }
+            else
+            {
+                HybridSortLoop(cut, last, depthLimit, comp, maxBlock, gaps);
+                last = cut;
+            }
+        }
+        Shellsort(first, last, gaps, comp);
+    }
+
+    // Best of the candidates found for sortingRange (Results and Results/Backups) and the baselines, by the current
+    // fitness function. Shellsort's small-block performance is exactly what the searches optimise
+    GapSequence GetBestBlockGaps(unsigned long sortingRange, int iterations, const std::vector<std::string>& paths = { "Results" })
+    {
+        std::vector<GapSequence> candidates =
+        {
+            GetTokudaGaps(sortingRange),
+            GetCiuraGaps(sortingRange),
+            GetLeeGaps(sortingRange),
+            GetSkeanEhrenborgJaromczykGaps(sortingRange)
+        };
+        for (GapSequence& gs : files::GetCandidateGapSequences(sortingRange, paths)) candidates.push_back(gs);
+
+        std::vector<Result> results = CompareShellsorts(sortingRange, candidates, iterations);
+        return results.front().gapSequence;
+    }
+}
+
+// Quicksort down to hybrid::blockSize, Shellsort with hybrid::blockGaps for blocks, heapsort past 2 log2(n) levels
+template <typename RandomIt, typename Compare = std::less<>>
+void HybridSort(RandomIt first, RandomIt last, Compare comp = {})
+{
+    const std::size_t size = last - first;
+    if (size < 2) return;
+    const int depthLimit = 2 * static_cast<int>(std::log2(static_cast<double>(size)));
+    hybrid::HybridSortLoop(first, last, depthLimit, comp, std::max<std::size_t>(hybrid::blockSize, 16), hybrid::blockGaps);
+}
+
+void HybridSort(std::vector<int>& arr)
+{
+    HybridSort(arr.begin(), arr.end());
+}
+
+namespace hybrid
+{
+    // Block size with the lowest mean time of HybridSort on sortingRange elements, each block size with its best gaps.
+    // hybrid::blockSize and hybrid::blockGaps are left set to the winner
+    std::size_t TuneBlockSize(unsigned long sortingRange, const std::vector<unsigned long>& blockSizes, int iterations)
+    {
+        double bestTime = 0.0;
+        std::size_t bestBlockSize = blockSize;
+        std::vector<unsigned long> bestGaps = blockGaps;
+        for (unsigned long candidateSize : blockSizes)
+        {
+            blockSize = candidateSize;
+            blockGaps = GetBestBlockGaps(candidateSize, iterations).gaps;
+
+            double time = 0.0;
+            for (int i = 0; i < iterations; i++)
+            {
+                std::vector<int> data = utilis::GetSortingDataForIteration(sortingRange, i);
+                auto start = std::chrono::high_resolution_clock::now();
+                HybridSort(data);
+                auto stop = std::chrono::high_resolution_clock::now();
+                time += std::chrono::duration<double, std::milli>(stop - start).count();
+            }
+            time /= std::max(1, iterations);
+
+            std::cout << "Hybrid sort: block size " << candidateSize << " - " << time << "ms\n";
+            if (bestTime == 0.0 || time < bestTime)
+            {
+                bestTime = time;
+                bestBlockSize = candidateSize;
+                bestGaps = blockGaps;
+            }
+        }
+        blockSize = bestBlockSize;
+        blockGaps = bestGaps;
+        return bestBlockSize;
+    }
+
+    struct BenchmarkResult
+    {
+        unsigned long sortingRange = 0;
+        std::string distribution;
+        double hybridTime = 0.0;
+        double stdSortTime = 0.0;
+
+        double GetSpeedup() const { return hybridTime > 0.0 ? stdSortTime / hybridTime : 0.0; }
+    };
+
+    // HybridSort against std::sort on the same datasets for every range and input shape, one after another in
+    // alternating order. Output is checked against std::sort, results are written to outputPath as CSV
+    std::vector<BenchmarkResult> CompareWithStdSort(const std::vector<unsigned long>& sortingRanges, int iterations, const std::string& outputPath = "Results/Hybrid/HybridBenchmark.csv")
+    {
+        std::filesystem::path path(outputPath);
+        if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path());
+        std::ofstream file(outputPath, std::ios::trunc);
+        if (!file.is_open()) std::cerr << "ERROR: Could not open file for writing: " << outputPath << std::endl;
+        file << "n,distribution,hybrid_ms,std_sort_ms,speedup,block_size\n";
+
+        std::vector<BenchmarkResult> results;
+        for (unsigned long n : sortingRanges)
+        {
+            for (int s = 0; s < static_cast<int>(distributions::Shape::SHAPES_COUNT); s++)
+            {
+                distributions::Distribution d;
+                d.shape = static_cast<distributions::Shape>(s);
+                BenchmarkResult r{ n, distributions::SHAPE_NAMES[s] };
+
+                for (int i = 0; i < iterations; i++)
+                {
+                    std::vector<int> data(n);
+                    const std::uint64_t seed = utilis::GetStreamSeed(0x4B1D5EEDULL ^ (static_cast<std::uint64_t>(n) << 20), i * 8 + s);
+                    distributions::Generate(data, d, [seed](std::uint64_t k) { return utilis::SplitMix64(seed + k); });
+                    std::vector<int> hybridData = data, stdData = data;
+
+                    for (int order = 0; order < 2; order++)
+                    {
+                        auto start = std::chrono::high_resolution_clock::now();
+                        if ((order + i) % 2 == 0) HybridSort(hybridData);
+                        else std::sort(stdData.begin(), stdData.end());
+                        auto stop = std::chrono::high_resolution_clock::now();
+                        ((order + i) % 2 == 0 ? r.hybridTime : r.stdSortTime) += std::chrono::duration<double, std::milli>(stop - start).count();
+                    }
+                    if (hybridData != stdData) std::cerr << "ERROR: Hybrid sort output differs from std::sort, n = " << n << ", " << r.distribution << std::endl;
+                }
+                r.hybridTime /= std::max(1, iterations);
+                r.stdSortTime /= std::max(1, iterations);
+                results.push_back(r);
+
+                file << n << "," << r.distribution << "," << r.hybridTime << "," << r.stdSortTime << "," << r.GetSpeedup() << "," << blockSize << "\n";
+                std::cout << "n = " << n << " " << r.distribution << ": hybrid " << r.hybridTime << "ms | std::sort " << r.stdSortTime << "ms | speedup " << r.GetSpeedup() << "\n";
+            }
+            file.flush();
+        }
+        std::cout << "Saved to: " << outputPath << std::endl;
+        return results;
+    }
+}
+
+
+#endif // !HYBRID_SORT_HPP
@@ -0,0 +1,228 @@
+#ifndef INPUT_DISTRIBUTIONS_HPP
+#define INPUT_DISTRIBUTIONS_HPP
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+
+// Shapes of input data beyond uniform noise. Generators take randomBits(k) - 64 counter-based random bits for
+// counter k - so a dataset stays a pure function of its seed, whatever the threads count
+namespace distributions
+{
+    enum class Shape { Uniform, NearlySorted, Reversed, FewUnique, OrganPipe, SortedRuns, SHAPES_COUNT };
+
+    const char* const SHAPE_NAMES[] = { "uniform", "nearlySorted", "reversed", "fewUnique", "organPipe", "sortedRuns" };
+
+    struct Distribution
+    {
+        Shape shape = Shape::Uniform;
+        // nearlySorted / reversed - fraction of elements moved by random swaps, default 0.01
+        // fewUnique - number of distinct values, default 16
+        // sortedRuns - length of every sorted run, default 32
+        // uniform, organPipe - unused
+        double parameter = -1.0;
+        double weight = 1.0; //share of datasets in a mixture
+        int minValue = -10000;
+        int maxValue = 10000;
+
+        double GetParameter(double defaultValue) const { return parameter >= 0.0 ? parameter : defaultValue; }
+    };
+
+    // Value in [minValue, maxValue] by multiply-shift of 32 random bits
+    inline int GetValue(std::uint64_t bits, const Distribution& d)
+    {
+        const std::uint64_t range = static_cast<std::uint64_t>(static_cast<std::int64_t>(d.maxValue) - d.minValue + 1);
+        return static_cast<int>(static_cast<std::int64_t>(((bits >> 32) * range) >> 32) + d.minValue);
+    }
+
+    // Value of rank i among n evenly spread over [minValue, maxValue]
+    inline int GetRankValue(std::size_t i, std::size_t n, const Distribution& d)
+    {
+        const double range = static_cast<double>(d.maxValue) - d.minValue;
+        return d.minValue + static_cast<int>(n > 1 ? range * i / (n - 1) : 0.0);
+    }
+
+    template <typename RandomBits>
+    void SwapRandomly(std::vector<int>& data, double fraction, RandomBits&& randomBits)
+    {
+        const std::size_t n = data.size();
+        const std::size_t swaps = static_cast<std::size_t>(fraction * n / 2.0);
+        for (std::size_t s = 0; s < swaps && n > 1; s++)
+        {
+            std::swap(data[randomBits(n + 2 * s) % n], data[randomBits(n + 2 * s + 1) % n]);
+        }
+    }
+
+    template <typename RandomBits>
+    void Generate(std::vector<int>& data, const Distribution& d, RandomBits&& randomBits)
+    {
+        const long n = static_cast<long>(data.size());
+        switch (d.shape)
+        {
+            case Shape::NearlySorted:
+            case Shape::Reversed:
+            {
+                const bool reversed = d.shape == Shape::Reversed;
+                #pragma omp parallel for
+                for (long i = 0; i < n; ++i) data[i] = GetRankValue(reversed ? n - 1 - i : i, n, d);
+                SwapRandomly(data, d.GetParameter(0.01), randomBits);
+                break;
+            }
+            case Shape::FewUnique:
+            {
+                const std::uint64_t unique = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(d.GetParameter(16.0)));
+                #pragma omp parallel for
+                for (long i = 0; i < n; ++i) data[i] = GetRankValue(randomBits(i) % unique, unique, d);
+                break;
+            }
+            case Shape::OrganPipe:
+            {
+                #pragma omp parallel for
+                for (long i = 0; i < n; ++i) data[i] = GetRankValue(std::min(i, n - 1 - i), (n + 1) / 2, d);
+                break;
+            }
+            case Shape::SortedRuns:
+            {
+                const long runLength = std::max<long>(1, static_cast<long>(d.GetParameter(32.0)));
+                #pragma omp parallel for
+                for (long i = 0; i < n; ++i) data[i] = GetValue(randomBits(i), d);
+                #pragma omp parallel for
+                for (long run = 0; run < n; run += runLength) std::sort(data.begin() + run, data.begin() + std::min(n, run + runLength));
+                break;
+            }
+            default:
+            {
+                #pragma omp parallel for
+                for (long i = 0; i < n; ++i) data[i] = GetValue(randomBits(i), d);
+                break;
+            }
+        }
+    }
+
+    // Component of the mixture for a dataset, chosen by weight from 64 random bits of its seed
+    inline const Distribution& PickFromMixture(const std::vector<Distribution>& mixture, std::uint64_t bits)
+    {
+        double totalWeight = 0.0;
+        for (const Distribution& d : mixture) totalWeight += d.weight;
+
+        double point = (bits >> 11) * (1.0 / 9007199254740992.0) * totalWeight;
+        for (const Distribution& d : mixture)
+        {
+            if (point < d.weight) return d;
+            point -= d.weight;
+        }
+        return mixture.back();
+    }
+
+    // Shortest text that parses back to the same value
+    inline std::string NumberToString(double value)
+    {
+        char buffer[32];
+        std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        return std::string(buffer, result.ptr);
+    }
+
+    // Mixture in the ParseMixture form, numbers round-trip exactly (empty mixture - "uniform:1", same as parsed "uniform")
+    inline std::string MixtureToString(const std::vector<Distribution>& mixture)
+    {
+        std::string description;
+        for (const Distribution& d : mixture.empty() ? std::vector<Distribution>(1) : mixture)
+        {
+            if (!description.empty()) description += ",";
+            description += SHAPE_NAMES[static_cast<int>(d.shape)];
+            if (d.parameter >= 0.0) description += "(" + NumberToString(d.parameter) + ")";
+            description += ":" + NumberToString(d.weight);
+        }
+        return description;
+    }
+
+    // Whole text as a finite number, surrounding spaces allowed
+    inline bool ParseNumber(const std::string& text, double& value)
+    {
+        char* end = nullptr;
+        value = std::strtod(text.c_str(), &end);
+        while (end != nullptr && std::isspace(static_cast<unsigned char>(*end))) end++;
+        return end != text.c_str() && *end == '\0' && std::isfinite(value);
+    }
+
+    // Parameter within the range its shape accepts, uniform and organPipe take none
+    inline bool IsValidParameter(Shape shape, double parameter)
+    {
+        switch (shape)
+        {
+            case Shape::NearlySorted:
+            case Shape::Reversed: return parameter >= 0.0 && parameter <= 1.0;
+            case Shape::FewUnique:
+            case Shape::SortedRuns: return parameter >= 1.0;
+            default: return false;
+        }
+    }
+
+    // "uniform:0.5,nearlySorted(0.02):0.3,fewUnique(8):0.2" - name(parameter):weight, parameter and weight optional.
+    // False (and mixture unchanged) on an unknown name, a malformed number, a weight <= 0 or a parameter out of range
+    inline bool ParseMixture(const std::string& description, std::vector<Distribution>& mixture)
+    {
+        std::vector<Distribution> parsed;
+        std::size_t begin = 0;
+        while (begin <= description.size())
+        {
+            std::size_t end = description.find(',', begin);
+            if (end == std::string::npos) end = description.size();
+            std::string item = description.substr(begin, end - begin);
+            begin = end + 1;
+            if (item.empty()) continue;
+
+            Distribution d;
+            std::size_t colon = item.find(':');
+            if (colon != std::string::npos)
+            {
+                if (!ParseNumber(item.substr(colon + 1), d.weight) || d.weight <= 0.0)
+                {
+                    std::cerr << "ERROR: Invalid input distribution weight: " << item << std::endl;
+                    return false;
+                }
+                item = item.substr(0, colon);
+            }
+            std::size_t parenthesis = item.find('(');
+            std::string parameter;
+            if (parenthesis != std::string::npos)
+            {
+                if (item.back() != ')')
+                {
+                    std::cerr << "ERROR: Invalid input distribution parameter: " << item << std::endl;
+                    return false;
+                }
+                parameter = item.substr(parenthesis + 1, item.size() - parenthesis - 2);
+                item = item.substr(0, parenthesis);
+            }
+
+            auto name = std::find(std::begin(SHAPE_NAMES), std::end(SHAPE_NAMES), item);
+            if (name == std::end(SHAPE_NAMES))
+            {
+                std::cerr << "ERROR: Unknown input distribution: " << item << std::endl;
+                return false;
+            }
+            d.shape = static_cast<Shape>(name - std::begin(SHAPE_NAMES));
+            if (parenthesis != std::string::npos && (!ParseNumber(parameter, d.parameter) || !IsValidParameter(d.shape, d.parameter)))
+            {
+                std::cerr << "ERROR: Invalid parameter of input distribution " << item << ": " << parameter << std::endl;
+                return false;
+            }
+            parsed.push_back(d);
+        }
+        if (parsed.empty()) return false;
+
+        mixture = parsed;
+        return true;
+    }
+}
+
+
+#endif // !INPUT_DISTRIBUTIONS_HPP
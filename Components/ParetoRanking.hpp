@@ -0,0 +1,121 @@
+#ifndef PARETO_RANKING_HPP
+#define PARETO_RANKING_HPP
+
+
+#include <iostream>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "ShellsortComparisons.hpp"
+
+// NSGA-II ranking - non-dominated fronts, then crowding distance inside a front
+namespace pareto
+{
+    // a is no worse than b in every objective and better in at least one
+    bool Dominates(const Result& a, const Result& b, const std::vector<FitnessObjective>& objectives)
+    {
+        bool better = false;
+        for (FitnessObjective objective : objectives)
+        {
+            double valueA = GetObjectiveValue(a, objective);
+            double valueB = GetObjectiveValue(b, objective);
+            if (valueA > valueB) return false;
+            if (valueA < valueB) better = true;
+        }
+        return better;
+    }
+
+    // Front index (0 - non-dominated) of every result, fast non-dominated sort
+    std::vector<int> GetFronts(const std::vector<Result>& results, const std::vector<FitnessObjective>& objectives)
+    {
+        int count = results.size();
+        std::vector<std::vector<int>> dominated(count);
+        std::vector<int> dominatedBy(count, 0);
+        std::vector<int> fronts(count, 0);
+
+        std::vector<int> current;
+        for (int p = 0; p < count; p++)
+        {
+            for (int q = 0; q < count; q++)
+            {
+                if (p == q) continue;
+                if (Dominates(results[p], results[q], objectives)) dominated[p].push_back(q);
+                else if (Dominates(results[q], results[p], objectives)) dominatedBy[p]++;
+            }
+            if (dominatedBy[p] == 0) current.push_back(p);
+        }
+
+        for (int front = 0; !current.empty(); front++)
+        {
+            std::vector<int> next;
+            for (int p : current)
+            {
+                fronts[p] = front;
+                for (int q : dominated[p]) if (--dominatedBy[q] == 0) next.push_back(q);
+            }
+            current = next;
+        }
+        return fronts;
+    }
+
+    // Crowding distance of the members of one front, boundary members are infinitely far
+    std::vector<double> GetCrowdingDistances(const std::vector<Result>& results, const std::vector<int>& members, const std::vector<FitnessObjective>& objectives)
+    {
+        std::vector<double> distances(members.size(), 0.0);
+        std::vector<int> order(members.size());
+        for (FitnessObjective objective : objectives)
+        {
+            for (std::size_t m = 0; m < members.size(); m++) order[m] = m;
+            std::sort(order.begin(), order.end(), [&](int a, int b) {
+                return GetObjectiveValue(results[members[a]], objective) < GetObjectiveValue(results[members[b]], objective);
+                });
+
+            double lowest = GetObjectiveValue(results[members[order.front()]], objective);
+            double highest = GetObjectiveValue(results[members[order.back()]], objective);
+            distances[order.front()] = distances[order.back()] = std::numeric_limits<double>::infinity();
+            if (highest <= lowest) continue;
+
+            for (std::size_t m = 1; m + 1 < order.size(); m++)
+            {
+                double gap = GetObjectiveValue(results[members[order[m + 1]]], objective) - GetObjectiveValue(results[members[order[m - 1]]], objective);
+                distances[order[m]] += gap / (highest - lowest);
+            }
+        }
+        return distances;
+    }
+}
+
+// Results ordered by front and, inside a front, by decreasing crowding distance - the NSGA-II selection order.
+// paretoRank of every result is set to its front (0 - non-dominated)
+std::vector<Result> SortByPareto(std::vector<Result> results, const std::vector<FitnessObjective>& objectives)
+{
+    std::vector<int> fronts = pareto::GetFronts(results, objectives);
+    std::vector<double> crowding(results.size(), 0.0);
+
+    int frontsCount = results.empty() ? 0 : *std::max_element(fronts.begin(), fronts.end()) + 1;
+    for (int front = 0; front < frontsCount; front++)
+    {
+        std::vector<int> members;
+        for (std::size_t r = 0; r < results.size(); r++) if (fronts[r] == front) members.push_back(r);
+        std::vector<double> distances = pareto::GetCrowdingDistances(results, members, objectives);
+        for (std::size_t m = 0; m < members.size(); m++) crowding[members[m]] = distances[m];
+    }
+
+    std::vector<int> order(results.size());
+    for (std::size_t r = 0; r < results.size(); r++)
+    {
+        order[r] = r;
+        results[r].paretoRank = fronts[r];
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        if (fronts[a] != fronts[b]) return fronts[a] < fronts[b];
+        return crowding[a] > crowding[b];
+        });
+
+    std::vector<Result> sorted;
+    for (int r : order) sorted.push_back(results[r]);
+    return sorted;
+}
+
+
+#endif // !PARETO_RANKING_HPP
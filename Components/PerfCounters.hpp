@@ -0,0 +1,124 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+
+#include <iostream>
+#include <array>
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// Hardware performance counters of the calling thread through Linux perf_event_open
+namespace perf_counters
+{
+    // MeasureShellsort_Full additionally measures hardware counters of every sort, in a second plain run of the same dataset
+    bool enabled = false;
+
+    enum Event { Cycles, Instructions, BranchMisses, L1Misses, LLCMisses, TLBMisses, EVENTS_COUNT };
+
+    const std::array<const char*, EVENTS_COUNT> EVENT_NAMES = { "cycles", "instructions", "branch-misses", "L1d-read-misses", "LLC-read-misses", "dTLB-read-misses" };
+
+    struct HardwareCounters
+    {
+        std::array<double, EVENTS_COUNT> values{}; //0 for events the machine does not support
+    };
+
+    // One counter per event, opened independently so the kernel can multiplex them when the PMU is short of counters,
+    // readings are scaled by time enabled / time running
+    class CounterGroup
+    {
+        public:
+        CounterGroup()
+        {
+            for (int e = 0; e < EVENTS_COUNT; e++) fds[e] = Open(static_cast<Event>(e));
+        }
+
+        ~CounterGroup()
+        {
+            for (int fd : fds) if (fd >= 0) close(fd);
+        }
+
+        CounterGroup(const CounterGroup&) = delete;
+        CounterGroup& operator=(const CounterGroup&) = delete;
+
+        bool IsAvailable() const { return fds[Cycles] >= 0; }
+
+        bool IsAvailable(Event event) const { return fds[event] >= 0; }
+
+        void Start()
+        {
+            for (int fd : fds)
+            {
+                if (fd < 0) continue;
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+
+        HardwareCounters Stop()
+        {
+            for (int fd : fds) if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            HardwareCounters counters;
+            for (int e = 0; e < EVENTS_COUNT; e++)
+            {
+                std::uint64_t reading[3] = { 0, 0, 0 }; //value, time enabled, time running
+                if (fds[e] < 0 || read(fds[e], reading, sizeof(reading)) != sizeof(reading) || reading[2] == 0) continue;
+                counters.values[e] = static_cast<double>(reading[0]) * static_cast<double>(reading[1]) / static_cast<double>(reading[2]);
+            }
+            return counters;
+        }
+
+        private:
+        std::array<int, EVENTS_COUNT> fds;
+
+        static int Open(Event event)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            const std::uint64_t readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            switch (event)
+            {
+                case Cycles: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+                case Instructions: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+                case BranchMisses: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+                case L1Misses: attr.type = PERF_TYPE_HW_CACHE; attr.config = PERF_COUNT_HW_CACHE_L1D | readMiss; break;
+                case LLCMisses: attr.type = PERF_TYPE_HW_CACHE; attr.config = PERF_COUNT_HW_CACHE_LL | readMiss; break;
+                case TLBMisses: attr.type = PERF_TYPE_HW_CACHE; attr.config = PERF_COUNT_HW_CACHE_DTLB | readMiss; break;
+                default: return -1;
+            }
+
+            //pid 0, cpu -1 - the calling thread on any CPU
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+    };
+
+    // Counters of the calling thread, opened on first use, OpenMP threads each get their own
+    CounterGroup& GetThreadCounters()
+    {
+        thread_local static CounterGroup counters;
+
+        static std::once_flag reported;
+        std::call_once(reported, [&]() {
+            std::string missing;
+            for (int e = 0; e < EVENTS_COUNT; e++) if (!counters.IsAvailable(static_cast<Event>(e))) missing += std::string(" ") + EVENT_NAMES[e];
+            if (!missing.empty()) std::cerr << "WARNING: Hardware counters not available, reported as 0:" << missing << " (check /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+        });
+
+        return counters;
+    }
+}
+
+
+#endif // !PERF_COUNTERS_HPP
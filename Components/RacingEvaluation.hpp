@@ -0,0 +1,206 @@
+#ifndef RACING_EVALUATION_HPP
+#define RACING_EVALUATION_HPP
+
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+#include "Shellsort.hpp"
+#include "ShellsortComparisons.hpp"
+#include "GapPrefixTrie.hpp"
+#include "FitnessCache.hpp"
+#include "TimingHarness.hpp"
+#include "Utilis.hpp"
+
+namespace racing
+{
+    struct Contender
+    {
+        Result sums;
+        std::vector<double> fitness; //per dataset, datasets are shared by all contenders alive at that time
+        int eliminatedAt = 0;
+    };
+
+    double GetMean(const std::vector<double>& values)
+    {
+        double sum = 0.0;
+        for (double v : values) sum += v;
+        return values.empty() ? 0.0 : sum / values.size();
+    }
+
+    double GetStdDev(const std::vector<double>& values)
+    {
+        if (values.size() < 2) return 0.0;
+        double mean = GetMean(values);
+        double sum = 0.0;
+        for (double v : values) sum += (v - mean) * (v - mean);
+        return std::sqrt(sum / (values.size() - 1));
+    }
+
+    // One-sided paired t-test on the common datasets: is candidate significantly worse than leader
+    bool IsSignificantlyWorse(const Contender& candidate, const Contender& leader, double confidence)
+    {
+        std::size_t samples = std::min(candidate.fitness.size(), leader.fitness.size());
+        if (samples < 2) return false;
+
+        std::vector<double> differences(samples);
+        for (std::size_t k = 0; k < samples; k++) differences[k] = candidate.fitness[k] - leader.fitness[k];
+
+        double mean = GetMean(differences);
+        double stdDev = GetStdDev(differences);
+        if (mean <= 0.0) return false;
+        if (stdDev == 0.0) return true;
+
+        double t = mean / (stdDev / std::sqrt(static_cast<double>(samples)));
+        return t > utilis::GetStudentTQuantile(confidence, static_cast<long>(samples) - 1);
+    }
+}
+
+namespace racing
+{
+    // With a cache: settled sequences are not raced (they keep their cached means and rank among the survivors),
+    // every new sample is added to the cache and results are means over all cached samples. With common random
+    // numbers the race starts past the datasets any contender has already seen, so no dataset is counted twice.
+    // Duplicated sequences are raced once and share the contender of their first occurrence
+    std::vector<Result> Race(unsigned long sortingRange, const std::vector<GapSequence>& gapSequences, int iterations, FitnessCache* cache, int minIterations, double confidence)
+    {
+        //Trie times of one dataset are taken by all threads at once, isolated timing measures the whole population instead
+        if (timing::IsSearchTimingIsolated()) return CompareShellsorts_Timed(sortingRange, gapSequences, iterations);
+
+        int sortsCount = gapSequences.size();
+        std::vector<Contender> contenders(sortsCount);
+        std::vector<int> representatives(sortsCount);
+        std::unordered_map<GapSequence, int, GapSequenceHash> firstPositions;
+        std::vector<int> alive;
+        long firstDataset = 0;
+        for (int j = 0; j < sortsCount; j++)
+        {
+            representatives[j] = firstPositions.emplace(gapSequences[j], j).first->second;
+            if (representatives[j] != j) continue;
+            if (cache != nullptr && cache->IsSettled(sortingRange, gapSequences[j].gaps)) continue;
+            if (cache != nullptr && utilis::commonRandomNumbers) firstDataset = std::max(firstDataset, cache->GetSamples(sortingRange, gapSequences[j].gaps));
+            alive.push_back(j);
+        }
+
+        long budget = static_cast<long>(iterations) * static_cast<long>(alive.size());
+        long spent = 0;
+
+        for (int i = 0; !alive.empty() && (alive.size() > 1 || i < minIterations) && spent + static_cast<long>(alive.size()) <= budget; i++)
+        {
+            // Get random data for sorting
+            std::vector<int> data = utilis::GetSortingDataForIteration(sortingRange, firstDataset + i);
+
+            std::vector<GapSequence> aliveSequences;
+            for (int j : alive) aliveSequences.push_back(gapSequences[j]);
+            std::vector<Result> results = GapPrefixTrie(aliveSequences).EvaluateDataset(data);
+            spent += alive.size();
+
+            for (std::size_t a = 0; a < alive.size(); a++)
+            {
+                Contender& c = contenders[alive[a]];
+                c.sums.time += results[a].time;
+                c.sums.comparisons += results[a].comparisons;
+                c.sums.loops += results[a].loops;
+                c.sums.operations += results[a].operations;
+                c.sums.moves += results[a].moves;
+                c.sums.AddHardwareCounters(results[a]);
+                c.fitness.push_back(results[a].GetFitnessScore());
+                if (cache != nullptr) cache->AddSample(sortingRange, gapSequences[alive[a]].gaps, results[a]);
+            }
+
+            // Getting best result for wins count
+            auto winner_it = std::min_element(results.begin(), results.end(),
+                [](const Result& a, const Result& b) {
+                    return a.GetFitnessScore() < b.GetFitnessScore();
+                }
+            );
+            contenders[alive[winner_it - results.begin()]].sums.wins++;
+
+            if (i + 1 < minIterations || alive.size() < 2) continue;
+
+            int leader = *std::min_element(alive.begin(), alive.end(), [&](int a, int b) {
+                return GetMean(contenders[a].fitness) < GetMean(contenders[b].fitness);
+                });
+
+            std::vector<int> stillAlive;
+            for (int j : alive)
+            {
+                if (j != leader && IsSignificantlyWorse(contenders[j], contenders[leader], confidence)) { contenders[j].eliminatedAt = i + 1; }
+                else { stillAlive.push_back(j); }
+            }
+            alive = stillAlive;
+        }
+        for (int j = 0; j < sortsCount; j++) if (representatives[j] != j) contenders[j] = contenders[representatives[j]];
+
+        std::vector<Result> avgResults(sortsCount);
+        for (int j = 0; j < sortsCount; j++)
+        {
+            const Contender& c = contenders[j];
+            double samples = std::max<double>(1.0, c.fitness.size());
+            Result& r = avgResults[j];
+            CachedFitness fitness;
+            if (cache != nullptr && cache->Get(sortingRange, gapSequences[j].gaps, fitness))
+            {
+                r = fitness.ToResult(gapSequences[j]);
+            }
+            else
+            {
+                r.time = c.sums.time / samples;
+                r.comparisons = c.sums.comparisons / samples;
+                r.loops = c.sums.loops / samples;
+                r.operations = c.sums.operations / samples;
+                r.moves = c.sums.moves / samples;
+                r.cycles = c.sums.cycles;
+                r.instructions = c.sums.instructions;
+                r.branchMisses = c.sums.branchMisses;
+                r.l1Misses = c.sums.l1Misses;
+                r.llcMisses = c.sums.llcMisses;
+                r.tlbMisses = c.sums.tlbMisses;
+                r.DivideHardwareCounters(samples);
+                r.gapSequence = gapSequences[j];
+                r.samples = c.fitness.size();
+            }
+            r.wins = c.sums.wins;
+            r.fitnessStdDev = GetStdDev(c.fitness);
+            r.confidenceInterval = c.fitness.size() > 1
+                ? utilis::GetStudentTQuantile(0.5 + confidence / 2.0, static_cast<long>(c.fitness.size()) - 1) * r.fitnessStdDev / std::sqrt(samples) : 0.0;
+            r.eliminated = c.eliminatedAt > 0;
+        }
+
+        std::vector<int> order(sortsCount);
+        for (int j = 0; j < sortsCount; j++) order[j] = j;
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            if (contenders[a].eliminatedAt != contenders[b].eliminatedAt)
+            {
+                if (contenders[a].eliminatedAt == 0) return true;
+                if (contenders[b].eliminatedAt == 0) return false;
+                return contenders[a].eliminatedAt > contenders[b].eliminatedAt;
+            }
+            return avgResults[a].GetFitnessScore() < avgResults[b].GetFitnessScore();
+            });
+
+        std::vector<Result> ranked;
+        for (int j : order) ranked.push_back(avgResults[j]);
+        return ranked;
+    }
+}
+
+// F-race style CompareShellsorts - after minIterations datasets, contenders significantly worse than the leader
+// (paired t-test) are dropped and the evaluation budget (iterations per sequence) goes to the remaining ones.
+// Ranking: surviving contenders by mean fitness, then eliminated ones from the latest to the earliest dropped
+std::vector<Result> CompareShellsorts_Racing(unsigned long sortingRange, std::vector<GapSequence> gapSequences, int iterations, int minIterations = 5, double confidence = 0.95)
+{
+    return racing::Race(sortingRange, gapSequences, iterations, nullptr, minIterations, confidence);
+}
+
+// Racing through the fitness cache - settled sequences are not raced, new samples are added to the cache and
+// ranking uses means over all cached samples, so survivors are not measured from scratch every generation
+std::vector<Result> CompareShellsorts_Racing(unsigned long sortingRange, std::vector<GapSequence> gapSequences, int iterations, FitnessCache& cache, int minIterations = 5, double confidence = 0.95)
+{
+    return racing::Race(sortingRange, gapSequences, iterations, &cache, minIterations, confidence);
+}
+
+
+#endif // !RACING_EVALUATION_HPP
@@ -0,0 +1,268 @@
+#ifndef SCALING_SWEEP_HPP
+#define SCALING_SWEEP_HPP
+
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <filesystem>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <omp.h>
+#include "Shellsort.hpp"
+#include "ShellsortComparisons.hpp"
+#include "GapExtrapolation.hpp"
+#include "Utilis.hpp"
+
+// Sweep of sorting ranges from 10^3 up to 10^8 with power law fits y = constant * n^exponent per sequence,
+// points are streamed to CSV as soon as they are measured
+namespace scaling
+{
+    struct SweepOptions
+    {
+        unsigned long minRange = 1000;
+        unsigned long maxRange = 100000000;
+        int pointsPerDecade = 2;
+        std::size_t memoryBudget = 2ULL << 30; //bytes for the dataset and arrays sorted at the same time
+        unsigned long elementsPerPoint = 20000000; //samples of a point = elementsPerPoint / n, within the limits below
+        long minSamples = 1;
+        long maxSamples = 100;
+        bool measureTime = true; //time of the plain kernel, sequences one after another
+        double operationsLimit = 200.0; //a sort is aborted past operationsLimit * n * log2(n), the sequence leaves the sweep
+        std::string outputPath = "Results/Scaling/ScalingSweep.csv";
+    };
+
+    // Gap sequence of a sequence family for a given sorting range
+    struct SweepSequence
+    {
+        std::string name;
+        std::function<GapSequence(unsigned long)> generator;
+    };
+
+    struct SweepPoint
+    {
+        std::string name;
+        unsigned long sortingRange = 0;
+        long samples = 0;
+        bool censored = false; //aborted by operationsLimit, counts are lower bounds
+        double comparisons = 0.0;
+        double operations = 0.0;
+        double moves = 0.0;
+        double time = 0.0;
+    };
+
+    struct ComplexityFit
+    {
+        std::string name;
+        std::string metric;
+        double exponent = 0.0;
+        double constant = 0.0;
+        double r2 = 0.0;
+        long points = 0;
+    };
+
+    std::vector<SweepSequence> GetBaselineSweepSequences()
+    {
+        return
+        {
+            SweepSequence{ "Tokuda", extrapolation::GetTokudaGaps },
+            SweepSequence{ "Ciura_Extended", extrapolation::GetCiuraExtendedGaps },
+            SweepSequence{ "Lee", extrapolation::GetLeeGaps },
+            SweepSequence{ "SEJ", extrapolation::GetSkeanEhrenborgJaromczykGaps }
+        };
+    }
+
+    // Sequence found for one range, gaps not below n are dropped at smaller ranges
+    SweepSequence GetFixedSweepSequence(const GapSequence& gapSequence)
+    {
+        return SweepSequence{ gapSequence.name, [gapSequence](unsigned long sortingRange) {
+            GapSequence gs = gapSequence;
+            gs.gaps.erase(std::remove_if(gs.gaps.begin(), gs.gaps.end(), [&](unsigned long gap) { return gap >= sortingRange && gap != 1; }), gs.gaps.end());
+            return gs;
+            } };
+    }
+
+    // Sequence found for one range, continued by its fitted growth ratio at larger ranges
+    SweepSequence GetExtendedSweepSequence(const GapSequence& gapSequence)
+    {
+        return SweepSequence{ gapSequence.name + "|Extended", [gapSequence](unsigned long sortingRange) {
+            return extrapolation::ExtendGapSequence(gapSequence, sortingRange);
+            } };
+    }
+
+    std::vector<unsigned long> GetSortingRanges(const SweepOptions& options)
+    {
+        std::vector<unsigned long> ranges;
+        const double step = std::pow(10.0, 1.0 / std::max(1, options.pointsPerDecade));
+        for (double n = static_cast<double>(options.minRange); n <= options.maxRange * 1.000001; n *= step)
+        {
+            unsigned long range = static_cast<unsigned long>(std::llround(n));
+            if (ranges.empty() || ranges.back() != range) ranges.push_back(range);
+        }
+        return ranges;
+    }
+
+    // Least squares on (ln n, ln y), points with y <= 0 are skipped
+    ComplexityFit FitPowerLaw(const std::string& name, const std::string& metric, const std::vector<std::pair<double, double>>& points)
+    {
+        ComplexityFit fit{ name, metric };
+        double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+        std::vector<std::pair<double, double>> logPoints;
+        for (const auto& point : points)
+        {
+            if (point.first <= 0.0 || point.second <= 0.0) continue;
+            double x = std::log(point.first), y = std::log(point.second);
+            logPoints.push_back({ x, y });
+            sumX += x; sumY += y; sumXX += x * x; sumXY += x * y;
+        }
+
+        fit.points = logPoints.size();
+        double count = static_cast<double>(logPoints.size());
+        double denominator = count * sumXX - sumX * sumX;
+        if (logPoints.size() < 2 || denominator == 0.0) return fit;
+
+        fit.exponent = (count * sumXY - sumX * sumY) / denominator;
+        double intercept = (sumY - fit.exponent * sumX) / count;
+        fit.constant = std::exp(intercept);
+
+        double meanY = sumY / count, residual = 0.0, total = 0.0;
+        for (const auto& point : logPoints)
+        {
+            double predicted = intercept + fit.exponent * point.first;
+            residual += (point.second - predicted) * (point.second - predicted);
+            total += (point.second - meanY) * (point.second - meanY);
+        }
+        fit.r2 = total > 0.0 ? 1.0 - residual / total : 1.0;
+        return fit;
+    }
+
+    // Every range sorts the same datasets for all sequences; sequences are counted in batches that fit the memory budget
+    // next to the dataset, so with the default 2 GiB at 10^8 (400 MB per array) four copies are sorted at a time.
+    // Censored points are written but not fitted.
+    // Returns fits of comparisons, operations, moves and time
+    std::vector<ComplexityFit> RunScalingSweep(const std::vector<SweepSequence>& sequences, const SweepOptions& options = {})
+    {
+        std::filesystem::path outputPath(options.outputPath);
+        if (outputPath.has_parent_path()) std::filesystem::create_directories(outputPath.parent_path());
+        std::ofstream points(options.outputPath, std::ios::trunc);
+        if (!points.is_open())
+        {
+            std::cerr << "ERROR: Could not open file for writing: " << options.outputPath << std::endl;
+            return {};
+        }
+        points.precision(12);
+        points << "sequence,n,samples,censored,comparisons,operations,moves,time_ms,gaps\n";
+
+        std::vector<std::vector<SweepPoint>> measured(sequences.size());
+        std::vector<char> active(sequences.size(), 1);
+        for (unsigned long n : GetSortingRanges(options))
+        {
+            std::size_t arrayBytes = static_cast<std::size_t>(n) * sizeof(int);
+            if (2 * arrayBytes > options.memoryBudget)
+            {
+                std::cerr << "WARNING: n = " << n << " does not fit the memory budget of " << options.memoryBudget << " bytes, sweep stopped" << std::endl;
+                break;
+            }
+            if (std::find(active.begin(), active.end(), 1) == active.end()) break;
+            int batchSize = static_cast<int>(std::max<std::size_t>(1, std::min<std::size_t>({ utilis::GetConcurrentCopies(arrayBytes, options.memoryBudget), sequences.size(), static_cast<std::size_t>(omp_get_max_threads()) })));
+            long samples = std::clamp<long>(static_cast<long>(options.elementsPerPoint / n), options.minSamples, options.maxSamples);
+            ShellsortBudget budget;
+            budget.operations = static_cast<unsigned long>(options.operationsLimit * n * std::log2(static_cast<double>(n)));
+
+            std::vector<GapSequence> gapSequences;
+            std::vector<SweepPoint> sums(sequences.size());
+            for (std::size_t q = 0; q < sequences.size(); q++)
+            {
+                gapSequences.push_back(active[q] ? sequences[q].generator(n) : GapSequence());
+                sums[q].name = sequences[q].name;
+                sums[q].sortingRange = n;
+                sums[q].samples = samples;
+            }
+
+            for (long s = 0; s < samples; s++)
+            {
+                std::vector<int> data = utilis::GetSortingData(n, static_cast<std::uint64_t>(s));
+
+                #pragma omp parallel for num_threads(batchSize) schedule(dynamic, 1)
+                for (int q = 0; q < static_cast<int>(sequences.size()); q++)
+                {
+                    if (!active[q] || sums[q].censored) continue;
+                    std::vector<int> arr = data;
+                    std::less<> comp;
+                    IdentityProjection proj;
+                    BudgetedCounters counter(budget);
+                    ShellsortKernel(arr.begin(), arr.end(), gapSequences[q].gaps, comp, proj, counter);
+                    sums[q].censored = counter.censored;
+                    sums[q].comparisons += counter.comparisons;
+                    sums[q].operations += counter.GetOperations();
+                    sums[q].moves += counter.moves;
+                }
+
+                for (std::size_t q = 0; options.measureTime && q < sequences.size(); q++)
+                {
+                    if (!active[q] || sums[q].censored) continue;
+                    sums[q].time += MeasureShellsort_Time(data, gapSequences[q]);
+                }
+            }
+
+            for (std::size_t q = 0; q < sequences.size(); q++)
+            {
+                if (!active[q]) continue;
+                SweepPoint& p = sums[q];
+                if (p.censored)
+                {
+                    active[q] = 0;
+                    std::cout << "Scaling sweep: " << p.name << " exceeded the operations limit at n = " << n << ", dropped" << std::endl;
+                }
+                p.comparisons /= samples;
+                p.operations /= samples;
+                p.moves /= samples;
+                p.time /= samples;
+                if (!p.censored) measured[q].push_back(p);
+
+                points << p.name << "," << n << "," << samples << "," << p.censored << "," << p.comparisons << "," << p.operations << "," << p.moves << "," << p.time << ",";
+                for (std::size_t g = 0; g < gapSequences[q].gaps.size(); g++) points << (g > 0 ? " " : "") << gapSequences[q].gaps[g];
+                points << "\n";
+            }
+            points.flush();
+            std::cout << "Scaling sweep: n = " << n << " done (" << samples << " samples)" << std::endl;
+        }
+
+        std::vector<ComplexityFit> fits;
+        for (std::size_t q = 0; q < sequences.size(); q++)
+        {
+            std::vector<std::pair<double, double>> comparisons, operations, moves, time;
+            for (const SweepPoint& p : measured[q])
+            {
+                comparisons.push_back({ static_cast<double>(p.sortingRange), p.comparisons });
+                operations.push_back({ static_cast<double>(p.sortingRange), p.operations });
+                moves.push_back({ static_cast<double>(p.sortingRange), p.moves });
+                time.push_back({ static_cast<double>(p.sortingRange), p.time });
+            }
+            fits.push_back(FitPowerLaw(sequences[q].name, "comparisons", comparisons));
+            fits.push_back(FitPowerLaw(sequences[q].name, "operations", operations));
+            fits.push_back(FitPowerLaw(sequences[q].name, "moves", moves));
+            if (options.measureTime) fits.push_back(FitPowerLaw(sequences[q].name, "time_ms", time));
+        }
+
+        std::string fitsPath = (outputPath.parent_path() / (outputPath.stem().string() + "_fits.csv")).string();
+        std::ofstream fitsFile(fitsPath, std::ios::trunc);
+        if (!fitsFile.is_open()) std::cerr << "ERROR: Could not open file for writing: " << fitsPath << std::endl;
+        fitsFile.precision(12);
+        fitsFile << "sequence,metric,exponent,constant,r2,points\n";
+        for (const ComplexityFit& fit : fits)
+        {
+            fitsFile << fit.name << "," << fit.metric << "," << fit.exponent << "," << fit.constant << "," << fit.r2 << "," << fit.points << "\n";
+            std::cout << fit.name << " " << fit.metric << " ~ " << fit.constant << " * n^" << fit.exponent << " (R^2 " << fit.r2 << ")\n";
+        }
+        std::cout << "Saved to: " << options.outputPath << " and " << fitsPath << std::endl;
+
+        return fits;
+    }
+}
+
+
+#endif // !SCALING_SWEEP_HPP
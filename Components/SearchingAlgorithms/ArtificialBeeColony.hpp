@@ -9,7 +9,9 @@
 #include "../Utilis.hpp"
 #include "../Shellsort.hpp"
 #include "../ShellsortComparisons.hpp"
+#include "../FitnessCache.hpp"
 #include "../FilesManagement.hpp"
+#include "../Checkpoint.hpp"
 
 namespace search_abc
 {
@@ -61,7 +63,7 @@ namespace search_abc
             neighborSolution.name = std::to_string(populationIndex) + "|EmployedNeighborhood|" + std::to_string(i + 1);
             currentFoodSource.name = std::to_string(populationIndex) + "|EmployedRemaining|" + std::to_string(i + 1); 
 
-            Result better = CompareShellsorts(sortingRange, { currentFoodSource, neighborSolution }, 10)[0];
+            Result better = CompareShellsorts(sortingRange, { currentFoodSource, neighborSolution }, 10, sharedFitnessCache)[0];
 
             if (better.gapSequence == neighborSolution)
             {
@@ -123,7 +125,7 @@ namespace search_abc
             neighborSolution.name = std::to_string(populationIndex) + "|OnlookerNeighborhood|" + std::to_string(selectedIndex + 1);
             currentFoodSource.name = std::to_string(populationIndex) + "|OnlookerRemaining|" + std::to_string(selectedIndex + 1); 
 
-            Result better = CompareShellsorts(sortingRange, { currentFoodSource, neighborSolution }, 10)[0];
+            Result better = CompareShellsorts(sortingRange, { currentFoodSource, neighborSolution }, 10, sharedFitnessCache)[0];
 
             if (better.gapSequence == neighborSolution)
             {
@@ -172,7 +174,7 @@ namespace search_abc
     {
         std::vector<Result> results;
 
-        std::vector<GapSequence> alreadyFound = 
+        GapSequenceSet alreadyFound = 
         { 
             GetTokudaGaps(sortingRange),
             GetCiuraGaps(sortingRange), 
@@ -186,7 +188,20 @@ namespace search_abc
             foodSources.push_back(FoodSource{ algorithmGapSequences[i], 0, 0});
         }
 
-        for (long i = 1; true; i++)
+        long firstGeneration = 1;
+        checkpoint::SearchState state;
+        if (checkpoint::resume && checkpoint::Load("abc", sortingRange, state))
+        {
+            firstGeneration = state.generation;
+            alreadyFound.insert(state.alreadyFound.begin(), state.alreadyFound.end());
+            foodSources.clear();
+            for (std::size_t k = 0; k < state.population.size(); k++)
+            {
+                foodSources.push_back(FoodSource{ state.population[k], 0, k < state.trialCounters.size() ? state.trialCounters[k] : 0 });
+            }
+        }
+
+        for (long i = firstGeneration; true; i++)
         {
             std::cout << "\n\nABC iteration " << i << ":\n";
             std::cout << "Gaps:\n";
@@ -200,18 +215,30 @@ namespace search_abc
             std::cout << "\nABC generated gaps";
             algorithmGapSequences.clear();
             for (FoodSource& fs : foodSources) algorithmGapSequences.push_back(fs.gapSequence);
-            results = CompareShellsorts(sortingRange, algorithmGapSequences, tryoutsIterations);
+            results = CompareShellsorts(sortingRange, algorithmGapSequences, tryoutsIterations, sharedFitnessCache);
 
             std::cout << "\nChecking for new best";
-            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations)[0].gapSequence;
+            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations, sharedFitnessCache)[0].gapSequence;
             if (best == results[0].gapSequence && !IsGapSequenceIn(best, alreadyFound))
             {
-                alreadyFound.push_back(best);
+                alreadyFound.insert(best);
                 std::cout << "\n\nNEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE\n\n";
                 files::SaveGapsToFile(sortingRange, "abc", best);
             }
 
             foodSources = GetNewPopulation(sortingRange, foodSources, i + 1);
+
+            if (checkpoint::IsDue(i))
+            {
+                std::vector<GapSequence> population;
+                std::vector<int> trialCounters;
+                for (FoodSource& fs : foodSources)
+                {
+                    population.push_back(fs.gapSequence);
+                    trialCounters.push_back(fs.trialCounter);
+                }
+                checkpoint::Save("abc", sortingRange, checkpoint::SearchState(i + 1, population, alreadyFound, 0, trialCounters));
+            }
         }
     }
 }
@@ -8,7 +8,9 @@
 #include <fstream>
 #include "../Shellsort.hpp"
 #include "../ShellsortComparisons.hpp"
+#include "../FitnessCache.hpp"
 #include "../FilesManagement.hpp"
+#include "../Checkpoint.hpp"
 
 namespace search_cuckoo
 {
@@ -100,7 +102,7 @@ namespace search_cuckoo
     {
         std::vector<Result> results;
 
-        std::vector<GapSequence> alreadyFound = 
+        GapSequenceSet alreadyFound = 
         { 
             GetTokudaGaps(sortingRange),
             GetCiuraGaps(sortingRange), 
@@ -108,7 +110,16 @@ namespace search_cuckoo
             GetSkeanEhrenborgJaromczykGaps(sortingRange) 
         };
 
-        for (long i = 1; true; i++)
+        long firstGeneration = 1;
+        checkpoint::SearchState state;
+        if (checkpoint::resume && checkpoint::Load("cuckoo", sortingRange, state))
+        {
+            firstGeneration = state.generation;
+            algorithmGapSequences = state.population;
+            alreadyFound.insert(state.alreadyFound.begin(), state.alreadyFound.end());
+        }
+
+        for (long i = firstGeneration; true; i++)
         {
             std::cout << "\n\nCuckoo iteration " << i << ":\n";
             std::cout << "Gaps:\n";
@@ -120,13 +131,13 @@ namespace search_cuckoo
             std::cout << "Sum of sequences: " << algorithmGapSequences.size() << "\n";
 
             std::cout << "\nCuckoo generated gaps";
-            results = CompareShellsorts(sortingRange, algorithmGapSequences, tryoutsIterations);
+            results = CompareShellsorts(sortingRange, algorithmGapSequences, tryoutsIterations, sharedFitnessCache, false, 2.0);
 
             std::cout << "\nChecking for new best";
-            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations)[0].gapSequence;
+            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations, sharedFitnessCache)[0].gapSequence;
             if (best == results[0].gapSequence && !IsGapSequenceIn(best, alreadyFound))
             {
-                alreadyFound.push_back(best);
+                alreadyFound.insert(best);
                 std::cout << "\n\nNEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE\n\n";
                 files::SaveGapsToFile(sortingRange, "cuckoo", best);
             }
@@ -136,6 +147,8 @@ namespace search_cuckoo
             for (Result& r : results) newGapSequences.push_back(r.gapSequence);
 
             algorithmGapSequences = GetNewPopulation(sortingRange, newGapSequences, i + 1);
+
+            if (checkpoint::IsDue(i)) checkpoint::Save("cuckoo", sortingRange, checkpoint::SearchState(i + 1, algorithmGapSequences, alreadyFound));
         }
     }
 }
@@ -8,7 +8,9 @@
 #include <fstream>
 #include "../Shellsort.hpp"
 #include "../ShellsortComparisons.hpp"
+#include "../FitnessCache.hpp"
 #include "../FilesManagement.hpp"
+#include "../Checkpoint.hpp"
 
 namespace search_genetic_v1
 {
@@ -66,7 +68,7 @@ namespace search_genetic_v1
     {
         std::vector<Result> results;
 
-        std::vector<GapSequence> alreadyFound = 
+        GapSequenceSet alreadyFound = 
         { 
             GetTokudaGaps(sortingRange),
             GetCiuraGaps(sortingRange), 
@@ -74,7 +76,16 @@ namespace search_genetic_v1
             GetSkeanEhrenborgJaromczykGaps(sortingRange) 
         };
 
-        for (long i = 1; true; i++)
+        long firstGeneration = 1;
+        checkpoint::SearchState state;
+        if (checkpoint::resume && checkpoint::Load("GAv1", sortingRange, state))
+        {
+            firstGeneration = state.generation;
+            algorithmGapSequences = state.population;
+            alreadyFound.insert(state.alreadyFound.begin(), state.alreadyFound.end());
+        }
+
+        for (long i = firstGeneration; true; i++)
         {
             std::cout << "\n\nGenetic Algorithm v1 iteration " << i << ":\n";
             std::cout << "Gaps sequences:\n";
@@ -86,13 +97,13 @@ namespace search_genetic_v1
             std::cout << "Sum of sequences: " << algorithmGapSequences.size() << "\n";
 
             std::cout << "\nGenetic Algorithm v1 generated gaps";
-            results = CompareShellsorts(sortingRange, algorithmGapSequences, tryoutsIterations);
+            results = CompareShellsorts(sortingRange, algorithmGapSequences, tryoutsIterations, sharedFitnessCache);
 
             std::cout << "\nChecking for new best";
-            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations)[0].gapSequence;
+            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations, sharedFitnessCache)[0].gapSequence;
             if (best == results[0].gapSequence && !IsGapSequenceIn(best, alreadyFound))
             {
-                alreadyFound.push_back(best);
+                alreadyFound.insert(best);
                 std::cout << "\n\nNEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE\n\n";
                 files::SaveGapsToFile(sortingRange, "GAv1", best);
             }
@@ -102,6 +113,8 @@ namespace search_genetic_v1
             for (Result& r : results) newGapSequences.push_back(r.gapSequence);
 
             algorithmGapSequences = GetNewPopulation(sortingRange, newGapSequences, i + 1);
+
+            if (checkpoint::IsDue(i)) checkpoint::Save("GAv1", sortingRange, checkpoint::SearchState(i + 1, algorithmGapSequences, alreadyFound));
         }
     }
 }
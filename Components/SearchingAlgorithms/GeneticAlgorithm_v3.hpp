@@ -9,7 +9,9 @@
 #include "../Utilis.hpp"
 #include "../Shellsort.hpp"
 #include "../ShellsortComparisons.hpp"
+#include "../FitnessCache.hpp"
 #include "../FilesManagement.hpp"
+#include "../Checkpoint.hpp"
 #include "CuckooSearch.hpp"
 
 namespace search_genetic_v3
@@ -130,7 +132,7 @@ namespace search_genetic_v3
     {
         std::vector<Result> results;
 
-        std::vector<GapSequence> alreadyFound = 
+        GapSequenceSet alreadyFound = 
         { 
             GetTokudaGaps(sortingRange),
             GetCiuraGaps(sortingRange), 
@@ -138,7 +140,16 @@ namespace search_genetic_v3
             GetSkeanEhrenborgJaromczykGaps(sortingRange) 
         };
 
-        for (long i = 1; true; i++)
+        long firstGeneration = 1;
+        checkpoint::SearchState state;
+        if (checkpoint::resume && checkpoint::Load("GAv3", sortingRange, state))
+        {
+            firstGeneration = state.generation;
+            algorithmGapSequences = state.population;
+            alreadyFound.insert(state.alreadyFound.begin(), state.alreadyFound.end());
+        }
+
+        for (long i = firstGeneration; true; i++)
         {
             std::cout << "\n\nGenetic Algorithm v3 iteration " << i << ":\n";
             std::cout << "Gaps sequences:\n";
@@ -150,13 +161,13 @@ namespace search_genetic_v3
             std::cout << "Sum of sequences: " << algorithmGapSequences.size() << "\n";
 
             std::cout << "\nGenetic Algorithm v3 generated gaps";
-            results = CompareShellsorts(sortingRange, algorithmGapSequences, tryoutsIterations);
+            results = CompareShellsorts(sortingRange, algorithmGapSequences, tryoutsIterations, sharedFitnessCache, false, 2.0);
 
             std::cout << "\nChecking for new best";
-            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations)[0].gapSequence;
+            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations, sharedFitnessCache)[0].gapSequence;
             if (best == results[0].gapSequence && !IsGapSequenceIn(best, alreadyFound))
             {
-                alreadyFound.push_back(best);
+                alreadyFound.insert(best);
                 std::cout << "\n\nNEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE\n\n";
                 files::SaveGapsToFile(sortingRange, "GAv3", best);
             }
@@ -166,6 +177,8 @@ namespace search_genetic_v3
             for (Result& r : results) newGapSequences.push_back(r.gapSequence);
 
             algorithmGapSequences = GetNewPopulation(sortingRange, newGapSequences, i + 1);
+
+            if (checkpoint::IsDue(i)) checkpoint::Save("GAv3", sortingRange, checkpoint::SearchState(i + 1, algorithmGapSequences, alreadyFound));
         }
     }
 }
@@ -9,7 +9,9 @@
 #include "../Utilis.hpp"
 #include "../Shellsort.hpp"
 #include "../ShellsortComparisons.hpp"
+#include "../FitnessCache.hpp"
 #include "../FilesManagement.hpp"
+#include "../Checkpoint.hpp"
 #include "CuckooSearch.hpp"
 
 namespace search_genetic_v4
@@ -177,7 +179,7 @@ namespace search_genetic_v4
     {
         std::vector<Result> results;
 
-        std::vector<GapSequence> alreadyFound = 
+        GapSequenceSet alreadyFound = 
         { 
             GetTokudaGaps(sortingRange),
             GetCiuraGaps(sortingRange), 
@@ -185,7 +187,16 @@ namespace search_genetic_v4
             GetSkeanEhrenborgJaromczykGaps(sortingRange) 
         };
 
-        for (long i = 1; true; i++)
+        long firstGeneration = 1;
+        checkpoint::SearchState state;
+        if (checkpoint::resume && checkpoint::Load("GAv4", sortingRange, state))
+        {
+            firstGeneration = state.generation;
+            algorithmGapSequences = state.population;
+            alreadyFound.insert(state.alreadyFound.begin(), state.alreadyFound.end());
+        }
+
+        for (long i = firstGeneration; true; i++)
         {
             std::cout << "\n\nGenetic Algorithm v4 iteration " << i << ":\n";
             std::cout << "Gaps sequences:\n";
@@ -197,13 +208,13 @@ namespace search_genetic_v4
             std::cout << "Sum of sequences: " << algorithmGapSequences.size() << "\n";
 
             std::cout << "\nGenetic Algorithm v4 generated gaps";
-            results = CompareShellsorts(sortingRange, algorithmGapSequences, tryoutsIterations);
+            results = CompareShellsorts(sortingRange, algorithmGapSequences, tryoutsIterations, sharedFitnessCache, false, 2.0);
 
             std::cout << "\nChecking for new best";
-            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations)[0].gapSequence;
+            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations, sharedFitnessCache)[0].gapSequence;
             if (best == results[0].gapSequence && !IsGapSequenceIn(best, alreadyFound))
             {
-                alreadyFound.push_back(best);
+                alreadyFound.insert(best);
                 std::cout << "\n\nNEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE\n\n";
                 files::SaveGapsToFile(sortingRange, "GAv4", best);
             }
@@ -213,6 +224,8 @@ namespace search_genetic_v4
             for (Result& r : results) newGapSequences.push_back(r.gapSequence);
 
             algorithmGapSequences = GetNewPopulation(sortingRange, newGapSequences, i + 1);
+
+            if (checkpoint::IsDue(i)) checkpoint::Save("GAv4", sortingRange, checkpoint::SearchState(i + 1, algorithmGapSequences, alreadyFound));
         }
     }
 }
@@ -9,12 +9,20 @@
 #include "../Utilis.hpp"
 #include "../Shellsort.hpp"
 #include "../ShellsortComparisons.hpp"
+#include "../FitnessCache.hpp"
+#include "../RacingEvaluation.hpp"
+#include "../TimingHarness.hpp"
+#include "../ParetoRanking.hpp"
 #include "../FilesManagement.hpp"
+#include "../Checkpoint.hpp"
 #include "CuckooSearch.hpp"
 
 namespace search_genetic_v5
 {
     long stagnatedGenerations = 0;
+    // Non-empty - NSGA-II style run: population ordered by Pareto front and crowding instead of GetFitnessScore,
+    // the first front is kept and every new non-dominated sequence is saved
+    std::vector<FitnessObjective> paretoObjectives = {};
 
     GapSequence MutateGapSequences(GapSequence gapSequence)
     {
@@ -159,10 +167,10 @@ namespace search_genetic_v5
         return childs;
     }
 
-    std::vector<GapSequence> GetNewPopulation(unsigned long sortingRange, std::vector<GapSequence> oldPopulation, int populationIndex)
+    std::vector<GapSequence> GetNewPopulationWithSurvivors(unsigned long sortingRange, std::vector<GapSequence> oldPopulation, int populationIndex, std::size_t survivorsCount)
     {
-        //Keep top 1 solutions, rest will be generated by crossing, mutation, and new random sequences
-        std::vector<GapSequence> newPopulation = std::vector<GapSequence>(oldPopulation.begin(), oldPopulation.begin() + 1);
+        //Keep top solutions, rest will be generated by crossing, mutation, and new random sequences
+        std::vector<GapSequence> newPopulation = std::vector<GapSequence>(oldPopulation.begin(), oldPopulation.begin() + survivorsCount);
         for (std::size_t i = 0; i < newPopulation.size(); ++i)
         {
             newPopulation[i].name = std::to_string(populationIndex) + "|Survivor|" + std::to_string(i + 1);
@@ -209,11 +217,67 @@ namespace search_genetic_v5
         return newPopulation;
     }
 
+    std::vector<GapSequence> GetNewPopulation(unsigned long sortingRange, std::vector<GapSequence> oldPopulation, int populationIndex)
+    {
+        return GetNewPopulationWithSurvivors(sortingRange, oldPopulation, populationIndex, 1);
+    }
+
+    // One NSGA-II style generation: population and reference sequences ranked together by Pareto front and crowding,
+    // first front members (without added references) survive and new ones are saved to CandidateGapSequences<range>_GAv5_pareto
+    std::vector<GapSequence> GetNextParetoPopulation(unsigned long sortingRange, const std::vector<GapSequence>& population, int tryoutsIterations, GapSequenceSet& alreadyFound, int populationIndex)
+    {
+        GapSequenceSet references;
+        std::vector<GapSequence> evaluated = population;
+        for (const GapSequence& reference : { GetTokudaGaps(sortingRange), GetCiuraGaps(sortingRange), GetLeeGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) })
+        {
+            if (IsGapSequenceIn(reference, population)) continue;
+            references.insert(reference);
+            evaluated.push_back(reference);
+        }
+
+        //A time objective is ranked on isolated times, contended ones of the parallel evaluation would decide the front
+        std::vector<Result> ranked = SortByPareto(timing::IsSearchTimingIsolated(paretoObjectives)
+            ? CompareShellsorts_Timed(sortingRange, evaluated, tryoutsIterations)
+            : CompareShellsorts(sortingRange, evaluated, tryoutsIterations, sharedFitnessCache), paretoObjectives);
+
+        std::vector<GapSequence> ordered;
+        std::size_t frontSize = 0;
+        bool foundNew = false;
+        for (const Result& r : ranked)
+        {
+            if (IsGapSequenceIn(r.gapSequence, references)) continue;
+            ordered.push_back(r.gapSequence);
+            if (r.paretoRank != 0) continue;
+
+            frontSize++;
+            if (IsGapSequenceIn(r.gapSequence, alreadyFound)) continue;
+            foundNew = true;
+            alreadyFound.insert(r.gapSequence);
+            files::SaveGapsToFile(sortingRange, "GAv5_pareto", r.gapSequence);
+        }
+
+        std::cout << "\nPareto front (" << frontSize << " sequences):";
+        for (const Result& r : ranked)
+        {
+            if (r.paretoRank != 0) break;
+            std::cout << "\n  " << r.gapSequence.name;
+            for (FitnessObjective objective : paretoObjectives) std::cout << " | " << GetObjectiveName(objective) << ": " << GetObjectiveValue(r, objective);
+        }
+        std::cout << "\n";
+
+        if (foundNew) stagnatedGenerations = 0;
+        else stagnatedGenerations++;
+
+        //At most 10% survivors, most spread out first front members come first
+        std::size_t survivorsCount = std::max<std::size_t>(1, std::min(frontSize, population.size() / 10));
+        return GetNewPopulationWithSurvivors(sortingRange, ordered, populationIndex, survivorsCount);
+    }
+
     void EndlessGapSeeking(unsigned long sortingRange, std::vector<GapSequence> algorithmGapSequences, int tryoutsIterations)
     {
         std::vector<Result> results;
 
-        std::vector<GapSequence> alreadyFound = 
+        GapSequenceSet alreadyFound = 
         { 
             GetTokudaGaps(sortingRange),
             GetCiuraGaps(sortingRange), 
@@ -221,7 +285,18 @@ namespace search_genetic_v5
             GetSkeanEhrenborgJaromczykGaps(sortingRange) 
         };
 
-        for (long i = 1; true; i++)
+        long firstGeneration = 1;
+        checkpoint::SearchState state;
+        const std::string checkpointName = paretoObjectives.empty() ? "GAv5" : "GAv5_pareto";
+        if (checkpoint::resume && checkpoint::Load(checkpointName, sortingRange, state))
+        {
+            firstGeneration = state.generation;
+            algorithmGapSequences = state.population;
+            alreadyFound.insert(state.alreadyFound.begin(), state.alreadyFound.end());
+            stagnatedGenerations = state.stagnatedGenerations;
+        }
+
+        for (long i = firstGeneration; true; i++)
         {
             std::cout << "\n\nGenetic Algorithm v5 iteration " << i << ":\n";
             std::cout << "Gaps sequences:\n";
@@ -233,26 +308,35 @@ namespace search_genetic_v5
             std::cout << "Sum of sequences: " << algorithmGapSequences.size() << "\n";
 
             std::cout << "\nGenetic Algorithm v5 generated gaps";
-            results = CompareShellsorts(sortingRange, algorithmGapSequences, tryoutsIterations);
-
-            std::cout << "\nChecking for new best";
-            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations)[0].gapSequence;
-            if (best == results[0].gapSequence && !IsGapSequenceIn(best, alreadyFound))
+            if (!paretoObjectives.empty())
             {
-                stagnatedGenerations = 0;
-                alreadyFound.push_back(best);
-                std::cout << "\n\nNEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE\n\n";
-                files::SaveGapsToFile(sortingRange, "GAv5", best);
+                algorithmGapSequences = GetNextParetoPopulation(sortingRange, algorithmGapSequences, tryoutsIterations, alreadyFound, i + 1);
             }
             else
             {
-                stagnatedGenerations++;
+                results = CompareShellsorts_Racing(sortingRange, algorithmGapSequences, tryoutsIterations, sharedFitnessCache);
+
+                std::cout << "\nChecking for new best";
+                GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations, sharedFitnessCache)[0].gapSequence;
+                if (best == results[0].gapSequence && !IsGapSequenceIn(best, alreadyFound))
+                {
+                    stagnatedGenerations = 0;
+                    alreadyFound.insert(best);
+                    std::cout << "\n\nNEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE ---------------------------- NEW CANDIDATE SEQUENCE\n\n";
+                    files::SaveGapsToFile(sortingRange, "GAv5", best);
+                }
+                else
+                {
+                    stagnatedGenerations++;
+                }
+
+                //creating new genetic sequences
+                std::vector<GapSequence> newGapSequences;
+                for (Result& r : results) newGapSequences.push_back(r.gapSequence);
+                algorithmGapSequences = GetNewPopulation(sortingRange, newGapSequences, i + 1);
             }
 
-            //creating new genetic sequences
-            std::vector<GapSequence> newGapSequences;
-            for (Result& r : results) newGapSequences.push_back(r.gapSequence);
-            algorithmGapSequences = GetNewPopulation(sortingRange, newGapSequences, i + 1);
+            if (checkpoint::IsDue(i)) checkpoint::Save(checkpointName, sortingRange, checkpoint::SearchState(i + 1, algorithmGapSequences, alreadyFound, stagnatedGenerations));
         }
     }
 }
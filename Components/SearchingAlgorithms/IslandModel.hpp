@@ -0,0 +1,291 @@
+#ifndef ISLAND_MODEL_HPP
+#define ISLAND_MODEL_HPP
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <unordered_map>
+#include <omp.h>
+#include "../Utilis.hpp"
+#include "../Shellsort.hpp"
+#include "../ShellsortComparisons.hpp"
+#include "../FitnessCache.hpp"
+#include "../RacingEvaluation.hpp"
+#include "../FilesManagement.hpp"
+#include "GeneticAlgorithm_v1.hpp"
+#include "GeneticAlgorithm_v2.hpp"
+#include "GeneticAlgorithm_v3.hpp"
+#include "GeneticAlgorithm_v4.hpp"
+#include "GeneticAlgorithm_v5.hpp"
+#include "CuckooSearch.hpp"
+#include "ArtificialBeeColony.hpp"
+
+namespace search_islands
+{
+    // Bounded lock-free multi-producer multi-consumer queue (Vyukov), every cell carries a sequence number
+    // telling producers and consumers whose turn it is
+    template <typename T>
+    class MigrationQueue
+    {
+        public:
+        MigrationQueue(std::size_t capacity = 256)
+        {
+            std::size_t size = 2;
+            while (size < capacity) size <<= 1;
+            mask = size - 1;
+            cells = std::unique_ptr<Cell[]>(new Cell[size]);
+            for (std::size_t i = 0; i < size; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        // False when the queue is full, migrants are then dropped
+        bool TryPush(const T& value)
+        {
+            std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell& cell = cells[position & mask];
+                std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+                if (difference == 0)
+                {
+                    if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        cell.value = value;
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0) return false;
+                else position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        bool TryPop(T& value)
+        {
+            std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell& cell = cells[position & mask];
+                std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+                if (difference == 0)
+                {
+                    if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        value = std::move(cell.value);
+                        cell.sequence.store(position + mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0) return false;
+                else position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        private:
+        struct Cell
+        {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        std::size_t mask = 0;
+        alignas(64) std::atomic<std::size_t> enqueuePosition{ 0 };
+        alignas(64) std::atomic<std::size_t> dequeuePosition{ 0 };
+    };
+
+    // Candidates saved by any island, a sequence is saved only by the first island that finds it
+    class CandidateRegistry
+    {
+        public:
+        // True if the sequence was not registered before
+        bool Register(const GapSequence& gapSequence)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return candidates.insert(gapSequence).second;
+        }
+
+        bool Contains(const GapSequence& gapSequence) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return candidates.count(gapSequence) > 0;
+        }
+
+        std::size_t Size() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return candidates.size();
+        }
+
+        private:
+        mutable std::mutex mutex;
+        GapSequenceSet candidates;
+    };
+
+    CandidateRegistry candidateRegistry;
+
+    struct Island
+    {
+        std::string name;
+        // Algorithm name used for the candidates file
+        std::string fileTag;
+        // Ranked results of a generation
+        std::function<std::vector<Result>(unsigned long, const std::vector<GapSequence>&, int)> evaluate;
+        // Next generation from the ranked population
+        std::function<std::vector<GapSequence>(unsigned long, const std::vector<GapSequence>&, int)> getNewPopulation;
+        // Optional, called after the new best check with its outcome
+        std::function<void(bool)> onBestChecked;
+    };
+
+    // Thread streams of islands, below the per-thread fallback streams of utilis
+    const long ISLAND_STREAM_OFFSET = 1L << 16;
+
+    std::mutex printMutex;
+
+    // Every search algorithm of the repository as an island, evaluated the same way as in its EndlessGapSeeking.
+    // Islands are ranked by the scalar fitness only, the GAv5 island ignores --pareto (its NSGA-II mode runs on its own)
+    std::vector<Island> GetDefaultIslands()
+    {
+        auto cached = [](unsigned long sortingRange, const std::vector<GapSequence>& population, int tryoutsIterations) {
+            return CompareShellsorts(sortingRange, population, tryoutsIterations, sharedFitnessCache);
+            };
+        auto cachedBudgeted = [](unsigned long sortingRange, const std::vector<GapSequence>& population, int tryoutsIterations) {
+            return CompareShellsorts(sortingRange, population, tryoutsIterations, sharedFitnessCache, false, 2.0);
+            };
+
+        // ABC keeps trial counters of its food sources between generations
+        auto foodSources = std::make_shared<std::unordered_map<GapSequence, int, GapSequenceHash>>();
+        auto abcNewPopulation = [foodSources](unsigned long sortingRange, const std::vector<GapSequence>& population, int populationIndex) {
+            std::vector<search_abc::FoodSource> sources;
+            for (const GapSequence& gs : population) sources.push_back(search_abc::FoodSource{ gs, 0, (*foodSources)[gs] });
+            sources = search_abc::GetNewPopulation(sortingRange, sources, populationIndex);
+
+            foodSources->clear();
+            std::vector<GapSequence> newPopulation;
+            for (const search_abc::FoodSource& fs : sources)
+            {
+                (*foodSources)[fs.gapSequence] = fs.trialCounter;
+                newPopulation.push_back(fs.gapSequence);
+            }
+            return newPopulation;
+            };
+
+        return
+        {
+            Island{ "GAv1", "GAv1", cached, search_genetic_v1::GetNewPopulation, nullptr },
+            Island{ "GAv2", "GAv2", cached, search_genetic_v2::GetNewPopulation, nullptr },
+            Island{ "GAv3", "GAv3", cachedBudgeted, search_genetic_v3::GetNewPopulation, nullptr },
+            Island{ "GAv4", "GAv4", cachedBudgeted, search_genetic_v4::GetNewPopulation, nullptr },
+            Island{ "GAv5", "GAv5",
+                [](unsigned long sortingRange, const std::vector<GapSequence>& population, int tryoutsIterations) {
+                    return CompareShellsorts_Racing(sortingRange, population, tryoutsIterations, sharedFitnessCache);
+                },
+                search_genetic_v5::GetNewPopulation,
+                [](bool newCandidate) {
+                    if (newCandidate) search_genetic_v5::stagnatedGenerations = 0;
+                    else search_genetic_v5::stagnatedGenerations++;
+                } },
+            Island{ "Cuckoo", "cuckoo", cachedBudgeted, search_cuckoo::GetNewPopulation, nullptr },
+            Island{ "ABC", "abc", cached, abcNewPopulation, nullptr }
+        };
+    }
+
+    void RunIsland(unsigned long sortingRange, std::vector<GapSequence> algorithmGapSequences, int tryoutsIterations,
+        Island& island, int islandIndex, std::vector<std::unique_ptr<MigrationQueue<GapSequence>>>& inboxes,
+        int threads, int migrationInterval, int migrantsCount)
+    {
+        utilis::SetThreadStream(ISLAND_STREAM_OFFSET + islandIndex);
+        omp_set_num_threads(threads);
+
+        for (long i = 1; true; i++)
+        {
+            std::vector<Result> results = island.evaluate(sortingRange, algorithmGapSequences, tryoutsIterations);
+
+            GapSequence best = CompareShellsorts(sortingRange, { results[0].gapSequence, GetCiuraGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) }, tryoutsIterations, sharedFitnessCache)[0].gapSequence;
+            bool newCandidate = best == results[0].gapSequence && candidateRegistry.Register(best);
+            if (island.onBestChecked) island.onBestChecked(newCandidate);
+            if (newCandidate) files::SaveGapsToFile(sortingRange, island.fileTag, best);
+
+            {
+                std::lock_guard<std::mutex> lock(printMutex);
+                std::cout << "[" << island.name << "] generation " << i << " | best operations: " << results[0].operations
+                    << (newCandidate ? " | NEW CANDIDATE SEQUENCE" : "") << "\n";
+            }
+
+            //Top sequences are sent to every other island
+            if (migrationInterval > 0 && i % migrationInterval == 0)
+            {
+                for (std::size_t target = 0; target < inboxes.size(); target++)
+                {
+                    if (static_cast<int>(target) == islandIndex) continue;
+                    for (int m = 0; m < migrantsCount && m < static_cast<int>(results.size()); m++)
+                    {
+                        GapSequence migrant = results[m].gapSequence;
+                        migrant.name = island.name + "|Migrant|" + std::to_string(m + 1);
+                        inboxes[target]->TryPush(migrant);
+                    }
+                }
+            }
+
+            std::vector<GapSequence> newGapSequences;
+            for (Result& r : results) newGapSequences.push_back(r.gapSequence);
+            algorithmGapSequences = island.getNewPopulation(sortingRange, newGapSequences, i + 1);
+
+            //Migrants replace the tail of the new population (random fill in most algorithms)
+            GapSequenceSet present(algorithmGapSequences.begin(), algorithmGapSequences.end());
+            std::size_t replaced = 0;
+            GapSequence migrant;
+            while (inboxes[islandIndex]->TryPop(migrant))
+            {
+                if (replaced + 1 >= algorithmGapSequences.size() || !present.insert(migrant).second) continue;
+                migrant.ValidateSequence(sortingRange);
+                algorithmGapSequences[algorithmGapSequences.size() - 1 - replaced] = migrant;
+                replaced++;
+            }
+        }
+    }
+
+    // Every island evolves its own population on its own std::thread with an equal share of the cores as its
+    // OpenMP team size, so no parallel region is nested. Runs are not reproducible from the run seed, migration
+    // depends on the timing of islands
+    void EndlessIslandSeeking(unsigned long sortingRange, std::vector<GapSequence> algorithmGapSequences, int tryoutsIterations,
+        std::vector<Island> islands = GetDefaultIslands(), int migrationInterval = 5, int migrantsCount = 3,
+        int totalThreads = static_cast<int>(std::thread::hardware_concurrency()))
+    {
+        for (const GapSequence& gs : { GetTokudaGaps(sortingRange), GetCiuraGaps(sortingRange), GetLeeGaps(sortingRange), GetSkeanEhrenborgJaromczykGaps(sortingRange) })
+        {
+            candidateRegistry.Register(gs);
+        }
+
+        const int islandsCount = static_cast<int>(islands.size());
+        if (islandsCount == 0) return;
+        if (totalThreads < islandsCount) totalThreads = islandsCount;
+
+        std::vector<std::unique_ptr<MigrationQueue<GapSequence>>> inboxes;
+        for (int k = 0; k < islandsCount; k++)
+        {
+            inboxes.push_back(std::unique_ptr<MigrationQueue<GapSequence>>(new MigrationQueue<GapSequence>(static_cast<std::size_t>(islandsCount * migrantsCount * 4))));
+        }
+
+        omp_set_dynamic(0);
+        std::vector<std::thread> workers;
+        for (int k = 0; k < islandsCount; k++)
+        {
+            int threads = totalThreads / islandsCount + (k < totalThreads % islandsCount ? 1 : 0);
+            std::cout << "Island " << islands[k].name << ": " << threads << " threads\n";
+            workers.emplace_back(RunIsland, sortingRange, algorithmGapSequences, tryoutsIterations, std::ref(islands[k]), k,
+                std::ref(inboxes), threads, migrationInterval, migrantsCount);
+        }
+
+        for (std::thread& worker : workers) worker.join();
+    }
+}
+
+#endif // !ISLAND_MODEL_HPP
@@ -4,9 +4,14 @@
 
 #include <iostream>
 #include <vector>
+#include <unordered_set>
 #include <tuple>
+#include <type_traits>
 #include <random>
 #include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
 #include "Utilis.hpp"
 
 class GapSequence
@@ -46,60 +51,183 @@ class GapSequence
     }
 };
 
-void Shellsort(std::vector<int>& arr, std::vector<unsigned long>& gaps)
+// Hash over gaps only, consistent with GapSequence::operator==
+struct GapSequenceHash
 {
-    for (unsigned long gap : gaps)
+    static std::size_t HashGaps(const std::vector<unsigned long>& gaps)
     {
-        for (unsigned long i = gap; i < arr.size(); i++)
+        std::size_t hash = 14695981039346656037ULL;
+        for (unsigned long gap : gaps)
         {
-            int temp = arr[i];
-            unsigned long j;
-            for (j = i; (j >= gap) && (arr[j - gap] > temp); j -= gap)
-            {
-                arr[j] = arr[j - gap];
-            }
-            arr[j] = temp;
+            hash ^= gap + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
         }
+        return hash;
     }
-}
 
-std::tuple<unsigned long, unsigned long, unsigned long> Shellsort_Stats(std::vector<int>& arr, std::vector<unsigned long>& gaps)
+    std::size_t operator()(const GapSequence& sequence) const
+    {
+        return HashGaps(sequence.gaps);
+    }
+};
+
+using GapSequenceSet = std::unordered_set<GapSequence, GapSequenceHash>;
+
+// Projection returning the element itself (std::identity is C++20)
+struct IdentityProjection
+{
+    template <typename T>
+    constexpr T&& operator()(T&& value) const noexcept { return std::forward<T>(value); }
+};
+
+// Counter policies for the Shellsort kernel - NoCounters compiles away, OperationCounters counts everything
+struct NoCounters
+{
+    bool ShouldAbort() const { return false; }
+    void Pass() {}
+    void Insertion() {}
+    void Comparison() {}
+    void Shift() {}
+    void Placement() {}
+};
+
+struct OperationCounters
 {
     unsigned long comparisons = 0;
     unsigned long loops = 0;
+    unsigned long moves = 0;
     unsigned long operations = 0;
 
-    for (unsigned long gap : gaps)
+    bool ShouldAbort() const { return false; }
+
+    void Pass() { loops++; }
+    void Insertion() { loops++; moves++; operations += 2; } //temp = arr[i], j = i
+    void Comparison() { loops++; comparisons++; }
+    void Shift() { moves++; operations += 2; } //arr[j] = arr[j - gap], j -= gap
+    void Placement() { moves++; operations += 1; } //arr[j] = temp
+
+    // Operations including loop control and comparisons
+    unsigned long GetOperations() const { return operations + loops + comparisons; }
+};
+
+// Limits for branch-and-bound evaluation, 0 - no limit
+struct ShellsortBudget
+{
+    unsigned long operations = 0;
+    unsigned long comparisons = 0;
+};
+
+// Counting policy that aborts the sort once a budget is exceeded - the result is then censored (a lower bound)
+struct BudgetedCounters : OperationCounters
+{
+    ShellsortBudget budget;
+    bool censored = false;
+
+    BudgetedCounters(ShellsortBudget budget) : budget(budget) {}
+
+    bool ShouldAbort()
     {
-        loops++; 
-        for (unsigned long i = gap; i < arr.size(); i++)
+        if ((budget.operations > 0 && GetOperations() > budget.operations) ||
+            (budget.comparisons > 0 && comparisons > budget.comparisons))
         {
-            loops++;
-            int temp = arr[i];
-            unsigned long j = i;
-            operations += 2;
-            while(j >= gap)
-            {
-                loops++;
-                comparisons++;
-                if (arr[j - gap] > temp)
-                {
-                    arr[j] = arr[j - gap];
-                    j -= gap;
-                    operations += 2;
-                }
-                else
-                {
-                    break;
-                }
-            }
-            arr[j] = temp;
-            operations += 1;
+            censored = true;
+        }
+        return censored;
+    }
+};
+
+// Single h-sorting pass over [first, last), element is shifted while comp(proj(temp), proj(previous)) holds
+// Gap can be unsigned long or std::integral_constant, in the latter case it is folded into address arithmetic
+template <typename RandomIt, typename GapT, typename Compare, typename Projection, typename Counter>
+void HSortPass(RandomIt first, RandomIt last, GapT gap, Compare& comp, Projection& proj, Counter& counter)
+{
+    using Value = typename std::iterator_traits<RandomIt>::value_type;
+    using Distance = typename std::iterator_traits<RandomIt>::difference_type;
+
+    counter.Pass();
+    const Distance size = last - first;
+    if (gap == 0 || gap >= static_cast<unsigned long>(size)) return;
+
+    const Distance h = static_cast<Distance>(gap);
+    for (Distance i = h; i < size; i++)
+    {
+        if (counter.ShouldAbort()) return;
+        counter.Insertion();
+        Value temp = std::move(first[i]);
+        Distance j = i;
+        while (j >= h)
+        {
+            counter.Comparison();
+            if (!std::invoke(comp, std::invoke(proj, temp), std::invoke(proj, first[j - h]))) break;
+
+            first[j] = std::move(first[j - h]);
+            j -= h;
+            counter.Shift();
         }
+        first[j] = std::move(temp);
+        counter.Placement();
+    }
+}
+
+// The one Shellsort kernel, timed and counted variants differ only by the counter policy
+template <typename RandomIt, typename Compare, typename Projection, typename Counter>
+void ShellsortKernel(RandomIt first, RandomIt last, const std::vector<unsigned long>& gaps, Compare& comp, Projection& proj, Counter& counter)
+{
+    for (unsigned long gap : gaps)
+    {
+        if (counter.ShouldAbort()) return;
+        HSortPass(first, last, gap, comp, proj, counter);
     }
+}
+
+// Generic Shellsort engine - any random access range, comparator and projection (key extraction)
+template <typename RandomIt, typename Compare = std::less<>, typename Projection = IdentityProjection>
+void Shellsort(RandomIt first, RandomIt last, const std::vector<unsigned long>& gaps, Compare comp = {}, Projection proj = {})
+{
+    NoCounters counter;
+    ShellsortKernel(first, last, gaps, comp, proj, counter);
+}
+
+void Shellsort(std::vector<int>& arr, std::vector<unsigned long>& gaps)
+{
+    Shellsort(arr.begin(), arr.end(), gaps);
+}
+
+// Compile-time gap sequence, e.g. Shellsort<701, 301, 132, 57, 23, 10, 4, 1>(arr.begin(), arr.end())
+template <unsigned long... Gaps, typename RandomIt, typename Compare = std::less<>, typename Projection = IdentityProjection>
+std::enable_if_t<(sizeof...(Gaps) > 0)> Shellsort(RandomIt first, RandomIt last, Compare comp = {}, Projection proj = {})
+{
+    static_assert(((Gaps > 0) && ...), "Gaps must be positive");
+    NoCounters counter;
+    (HSortPass(first, last, std::integral_constant<unsigned long, Gaps>{}, comp, proj, counter), ...);
+}
+
+template <unsigned long... Gaps>
+std::enable_if_t<(sizeof...(Gaps) > 0)> Shellsort(std::vector<int>& arr)
+{
+    Shellsort<Gaps...>(arr.begin(), arr.end());
+}
+
+using FixedShellsortKernel = void (*)(std::vector<int>&);
+
+std::tuple<unsigned long, unsigned long, unsigned long> Shellsort_Stats(std::vector<int>& arr, std::vector<unsigned long>& gaps)
+{
+    std::less<> comp;
+    IdentityProjection proj;
+    OperationCounters counter;
+    ShellsortKernel(arr.begin(), arr.end(), gaps, comp, proj, counter);
+
+    return std::make_tuple(counter.comparisons, counter.loops, counter.GetOperations());
+}
+
+// Comparisons, loops, operations and censored flag - the sort is aborted once the budget is exceeded
+std::tuple<unsigned long, unsigned long, unsigned long, bool> Shellsort_Stats(std::vector<int>& arr, std::vector<unsigned long>& gaps, ShellsortBudget budget)
+{
+    std::less<> comp;
+    IdentityProjection proj;
+    BudgetedCounters counter(budget);
+    ShellsortKernel(arr.begin(), arr.end(), gaps, comp, proj, counter);
 
-    operations += (loops + comparisons);
-    return std::make_tuple(comparisons, loops, operations);
+    return std::make_tuple(counter.comparisons, counter.loops, counter.GetOperations(), counter.censored);
 }
 
 // Tokuda 1992: 1, 4, 9, 20, 46, 103, 233, 525, 1182, 2660, 5985, 13467, 30301, 68178...
@@ -0,0 +1,109 @@
+#ifndef SHELLSORT_CHAIN_TRANSPOSE_HPP
+#define SHELLSORT_CHAIN_TRANSPOSE_HPP
+
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include "Shellsort.hpp"
+
+namespace chain_transpose
+{
+    // Tunables: gaps with stride of at least minimumGapBytes are transposed, chainsPerBlock chains are gathered at once
+    unsigned long minimumGapBytes = 65536;
+    unsigned long chainsPerBlock = 16;
+    unsigned long prefetchRows = 8;
+
+    template <typename T>
+    inline void Prefetch(const T* address)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address, 0, 0);
+#else
+        (void)address;
+#endif
+    }
+
+    // Chains c0..c0+width-1 are gathered row by row into compact scratch, insertion sorted there and scattered back
+    template <typename T>
+    void HSortPass_Transposed(std::vector<T>& arr, std::size_t gap, std::vector<T>& scratch, std::size_t blockWidth, std::size_t prefetchDistance)
+    {
+        const std::size_t size = arr.size();
+        const std::size_t rows = (size + gap - 1) / gap;
+
+        for (std::size_t c0 = 0; c0 < gap; c0 += blockWidth)
+        {
+            const std::size_t width = std::min(blockWidth, gap - c0);
+            scratch.resize(width * rows);
+
+            //Gather - each row of the block is a contiguous piece of arr
+            for (std::size_t r = 0; r < rows; r++)
+            {
+                const std::size_t base = r * gap + c0;
+                if (base >= size) break;
+                if (base + prefetchDistance * gap < size) Prefetch(&arr[base + prefetchDistance * gap]);
+
+                const std::size_t rowWidth = std::min(width, size - base);
+                for (std::size_t b = 0; b < rowWidth; b++) scratch[r * width + b] = arr[base + b];
+            }
+
+            //Insertion sort of every chain in contiguous memory
+            for (std::size_t b = 0; b < width; b++)
+            {
+                const std::size_t chain = c0 + b;
+                if (chain >= size) break;
+
+                T* values = scratch.data() + b;
+                const std::size_t length = (size - chain + gap - 1) / gap;
+                for (std::size_t i = 1; i < length; i++)
+                {
+                    T temp = values[i * width];
+                    std::size_t j;
+                    for (j = i; (j >= 1) && (values[(j - 1) * width] > temp); j--)
+                    {
+                        values[j * width] = values[(j - 1) * width];
+                    }
+                    values[j * width] = temp;
+                }
+            }
+
+            //Scatter back in the same row order
+            for (std::size_t r = 0; r < rows; r++)
+            {
+                const std::size_t base = r * gap + c0;
+                if (base >= size) break;
+                if (base + prefetchDistance * gap < size) Prefetch(&arr[base + prefetchDistance * gap]);
+
+                const std::size_t rowWidth = std::min(width, size - base);
+                for (std::size_t b = 0; b < rowWidth; b++) arr[base + b] = scratch[r * width + b];
+            }
+        }
+    }
+}
+
+// Shellsort where passes with gap * sizeof(int) >= minimumGapBytes run on transposed chains, remaining passes are standard
+void Shellsort_ChainTranspose(std::vector<int>& arr, std::vector<unsigned long>& gaps,
+    unsigned long minimumGapBytes = chain_transpose::minimumGapBytes)
+{
+    std::vector<int> scratch;
+    std::less<> comp;
+    IdentityProjection proj;
+    NoCounters counter;
+
+    for (unsigned long gap : gaps)
+    {
+        if (gap == 0 || gap >= arr.size()) continue;
+
+        if (gap * sizeof(int) >= minimumGapBytes)
+        {
+            chain_transpose::HSortPass_Transposed(arr, gap, scratch, chain_transpose::chainsPerBlock, chain_transpose::prefetchRows);
+        }
+        else
+        {
+            HSortPass(arr.begin(), arr.end(), gap, comp, proj, counter);
+        }
+    }
+}
+
+
+#endif // !SHELLSORT_CHAIN_TRANSPOSE_HPP
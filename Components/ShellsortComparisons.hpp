@@ -6,8 +6,17 @@
 #include <vector>
 #include <chrono>
 #include <algorithm>
+#include <string>
+#include <cstdlib>
+#include <cctype>
+#include <cmath>
 #include <omp.h>
 #include "Shellsort.hpp"
+#include "ShellsortSIMD.hpp"
+#include "ShellsortChainTranspose.hpp"
+#include "ShellsortParallel.hpp"
+#include "ShellsortRecords.hpp"
+#include "PerfCounters.hpp"
 #include "Utilis.hpp"
 
 struct Result
@@ -16,96 +25,447 @@ struct Result
     double comparisons = 0;
     double loops = 0;
     double operations = 0;
+    double moves = 0;
     GapSequence gapSequence;
     int wins = 0;
+    long samples = 0;
+    double fitnessStdDev = 0.0;
+    double confidenceInterval = 0.0; //half-width around mean fitness
+    bool eliminated = false;
+    int censored = 0; //samples aborted by budget, their counts are lower bounds
+    // Hardware counters per sort, measured only with perf_counters::enabled
+    double cycles = 0.0;
+    double instructions = 0.0;
+    double branchMisses = 0.0;
+    double l1Misses = 0.0;
+    double llcMisses = 0.0;
+    double tlbMisses = 0.0;
+    // Isolated timing only (CompareShellsorts_Timed), time is then the median over datasets
+    double timeMad = 0.0;
+    double timeConfidenceInterval = 0.0; //half-width of the median's interval
+    int paretoRank = 0; //non-dominated front, set by SortByPareto
+    double elementBytes = sizeof(int); //bytes carried by one move, records modes move more (or less) than an int
 
-    double GetFitnessScore() const
+    double GetFitnessScore() const;
+
+    void SetHardwareCounters(const perf_counters::HardwareCounters& counters)
+    {
+        cycles = counters.values[perf_counters::Cycles];
+        instructions = counters.values[perf_counters::Instructions];
+        branchMisses = counters.values[perf_counters::BranchMisses];
+        l1Misses = counters.values[perf_counters::L1Misses];
+        llcMisses = counters.values[perf_counters::LLCMisses];
+        tlbMisses = counters.values[perf_counters::TLBMisses];
+    }
+
+    // Sums of hardware counters, divided later like the other fields
+    void AddHardwareCounters(const Result& other)
+    {
+        cycles += other.cycles;
+        instructions += other.instructions;
+        branchMisses += other.branchMisses;
+        l1Misses += other.l1Misses;
+        llcMisses += other.llcMisses;
+        tlbMisses += other.tlbMisses;
+    }
+
+    void DivideHardwareCounters(double samples)
     {
-        return operations;
+        cycles /= samples;
+        instructions /= samples;
+        branchMisses /= samples;
+        l1Misses /= samples;
+        llcMisses /= samples;
+        tlbMisses /= samples;
+    }
+};
+
+// Result fields the searches can minimize, hardware objectives need perf_counters::enabled
+enum class FitnessObjective { Operations, Time, Comparisons, Loops, Moves, MovedBytes, Cycles, Instructions, BranchMisses, L1Misses, LLCMisses, TLBMisses, OBJECTIVES_COUNT };
+
+const char* const OBJECTIVE_NAMES[] = { "operations", "time", "comparisons", "loops", "moves", "movedBytes", "cycles", "instructions", "branchMisses", "l1Misses", "llcMisses", "tlbMisses" };
+
+double GetObjectiveValue(const Result& result, FitnessObjective objective)
+{
+    switch (objective)
+    {
+        case FitnessObjective::Time: return result.time;
+        case FitnessObjective::Comparisons: return result.comparisons;
+        case FitnessObjective::Loops: return result.loops;
+        case FitnessObjective::Moves: return result.moves;
+        case FitnessObjective::MovedBytes: return result.moves * result.elementBytes;
+        case FitnessObjective::Cycles: return result.cycles;
+        case FitnessObjective::Instructions: return result.instructions;
+        case FitnessObjective::BranchMisses: return result.branchMisses;
+        case FitnessObjective::L1Misses: return result.l1Misses;
+        case FitnessObjective::LLCMisses: return result.llcMisses;
+        case FitnessObjective::TLBMisses: return result.tlbMisses;
+        default: return result.operations;
+    }
+}
+
+const char* GetObjectiveName(FitnessObjective objective)
+{
+    return OBJECTIVE_NAMES[static_cast<int>(objective)];
+}
+
+bool ParseObjective(std::string name, FitnessObjective& objective)
+{
+    name.erase(std::remove_if(name.begin(), name.end(), [](unsigned char c) { return std::isspace(c); }), name.end());
+    for (int o = 0; o < static_cast<int>(FitnessObjective::OBJECTIVES_COUNT); o++)
+    {
+        if (name == OBJECTIVE_NAMES[o]) { objective = static_cast<FitnessObjective>(o); return true; }
+    }
+    return false;
+}
+
+// Weighted sum of objectives minimized by GetFitnessScore, e.g. "operations" or "0.7*time+0.3*moves"
+struct FitnessFunction
+{
+    std::vector<std::pair<FitnessObjective, double>> terms = { { FitnessObjective::Operations, 1.0 } };
+
+    double Evaluate(const Result& result) const
+    {
+        double score = 0.0;
+        for (const auto& term : terms) score += term.second * GetObjectiveValue(result, term.first);
+        return score;
+    }
+
+    bool Uses(FitnessObjective objective) const
+    {
+        return std::any_of(terms.begin(), terms.end(), [&](const auto& term) { return term.first == objective && term.second != 0.0; });
+    }
+
+    std::string ToString() const
+    {
+        std::string description;
+        for (const auto& term : terms)
+        {
+            if (!description.empty()) description += "+";
+            if (term.second != 1.0) description += std::to_string(term.second) + "*";
+            description += GetObjectiveName(term.first);
+        }
+        return description;
+    }
+
+    // Terms split on '+', except the exponent sign of a weight like "1e+3*time"
+    static std::vector<std::string> SplitTerms(const std::string& description)
+    {
+        std::vector<std::string> terms(1);
+        for (std::size_t c = 0; c < description.size(); c++)
+        {
+            bool exponentSign = c >= 2 && (description[c - 1] == 'e' || description[c - 1] == 'E')
+                && (std::isdigit(static_cast<unsigned char>(description[c - 2])) || description[c - 2] == '.');
+            if (description[c] == '+' && !exponentSign) terms.push_back("");
+            else terms.back() += description[c];
+        }
+        return terms;
+    }
+
+    // False (and the function unchanged) if the description has an unknown objective, an empty term or a weight
+    // that is not a whole finite number
+    bool Parse(const std::string& description)
+    {
+        std::vector<std::pair<FitnessObjective, double>> parsed;
+        for (const std::string& term : SplitTerms(description))
+        {
+            std::size_t star = term.find('*');
+            std::string name = star == std::string::npos ? term : term.substr(star + 1);
+            double weight = 1.0;
+            FitnessObjective objective;
+            if (star != std::string::npos)
+            {
+                char* end = nullptr;
+                std::string strWeight = term.substr(0, star);
+                weight = std::strtod(strWeight.c_str(), &end);
+                while (end != nullptr && std::isspace(static_cast<unsigned char>(*end))) end++;
+                if (end == strWeight.c_str() || *end != '\0' || !std::isfinite(weight))
+                {
+                    std::cerr << "ERROR: Invalid fitness weight: " << strWeight << std::endl;
+                    return false;
+                }
+            }
+            if (!ParseObjective(name, objective)) { std::cerr << "ERROR: Unknown fitness objective: " << name << std::endl; return false; }
+            parsed.push_back({ objective, weight });
+        }
+        if (parsed.empty()) return false;
+
+        terms = parsed;
+        return true;
     }
 };
 
-double MeasureShellsort_Time(std::vector<int> data, GapSequence gapSequence)
+FitnessFunction fitnessFunction;
+
+void SetFitnessObjective(FitnessObjective objective)
+{
+    fitnessFunction.terms = { { objective, 1.0 } };
+}
+
+double Result::GetFitnessScore() const
+{
+    return fitnessFunction.Evaluate(*this);
+}
+
+// Kernel variants with identical operation counts but different memory access patterns
+enum class ShellsortMode { Standard, SIMD, ChainTranspose };
+
+void Shellsort(std::vector<int>& arr, std::vector<unsigned long>& gaps, ShellsortMode mode)
+{
+    switch (mode)
+    {
+        case ShellsortMode::SIMD: Shellsort_SIMD(arr, gaps); break;
+        case ShellsortMode::ChainTranspose: Shellsort_ChainTranspose(arr, gaps); break;
+        default: Shellsort(arr, gaps); break;
+    }
+}
+
+double MeasureShellsort_Time(std::vector<int> data, GapSequence gapSequence, ShellsortMode mode = ShellsortMode::Standard)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    Shellsort(data, gapSequence.gaps, mode);
+    auto stop = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> elapsed = stop - start;
+    return elapsed.count();
+}
+
+// Time measurement for any element type, e.g. 64-bit keys, doubles or key+payload records
+template <typename T, typename Compare = std::less<>, typename Projection = IdentityProjection>
+double MeasureShellsort_Time(std::vector<T> data, GapSequence gapSequence, Compare comp = {}, Projection proj = {})
 {
     auto start = std::chrono::high_resolution_clock::now();
-    Shellsort(data, gapSequence.gaps);
+    Shellsort(data.begin(), data.end(), gapSequence.gaps, comp, proj);
     auto stop = std::chrono::high_resolution_clock::now();
 
     std::chrono::duration<double, std::milli> elapsed = stop - start;
     return elapsed.count();
 }
 
+// Time and hardware counters of the plain kernel, without software counting that would disturb them
+Result MeasureShellsort_Hardware(std::vector<int> data, GapSequence gapSequence, ShellsortMode mode = ShellsortMode::Standard)
+{
+    perf_counters::CounterGroup& counters = perf_counters::GetThreadCounters();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    counters.Start();
+    Shellsort(data, gapSequence.gaps, mode);
+    perf_counters::HardwareCounters hardware = counters.Stop();
+    auto stop = std::chrono::high_resolution_clock::now();
+
+    Result result;
+    result.time = std::chrono::duration<double, std::milli>(stop - start).count();
+    result.gapSequence = gapSequence;
+    result.SetHardwareCounters(hardware);
+    return result;
+}
+
+// Time and software counters of one sort. With perf_counters::enabled every dataset is sorted twice - hardware counters
+// come from a separate plain-kernel run, since counting every comparison would distort them - and time stays the counted run's
 Result MeasureShellsort_Full(std::vector<int> data, GapSequence gapSequence)
 {
-    //comparisons, loops, operations
-    std::tuple<unsigned long, unsigned long, unsigned long> stats;
+    Result hardware;
+    if (perf_counters::enabled) hardware = MeasureShellsort_Hardware(data, gapSequence);
+
+    std::less<> comp;
+    IdentityProjection proj;
+    OperationCounters counter;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    ShellsortKernel(data.begin(), data.end(), gapSequence.gaps, comp, proj, counter);
+    auto stop = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> elapsed = stop - start;
+    Result result{ elapsed.count(), (double)counter.comparisons, (double)counter.loops, (double)counter.GetOperations(), (double)counter.moves, gapSequence };
+    result.AddHardwareCounters(hardware);
+    return result;
+}
+
+// Budgeted variant, hardware counters (of the extra plain run) are kept only for sorts that finished within the budget
+Result MeasureShellsort_Full(std::vector<int> data, GapSequence gapSequence, ShellsortBudget budget)
+{
+    Result hardware;
+    if (perf_counters::enabled) hardware = MeasureShellsort_Hardware(data, gapSequence);
+
+    std::less<> comp;
+    IdentityProjection proj;
+    BudgetedCounters counter(budget);
 
     auto start = std::chrono::high_resolution_clock::now();
-    stats = Shellsort_Stats(data, gapSequence.gaps);
+    ShellsortKernel(data.begin(), data.end(), gapSequence.gaps, comp, proj, counter);
     auto stop = std::chrono::high_resolution_clock::now();
 
     std::chrono::duration<double, std::milli> elapsed = stop - start;
-    return Result{ elapsed.count(), (double)std::get<0>(stats), (double)std::get<1>(stats), (double)std::get<2>(stats), gapSequence };
+    Result result{ elapsed.count(), (double)counter.comparisons, (double)counter.loops, (double)counter.GetOperations(), (double)counter.moves, gapSequence };
+    result.censored = counter.censored ? 1 : 0;
+    if (!counter.censored) result.AddHardwareCounters(hardware);
+    return result;
 }
 
-std::vector<Result> CompareShellsorts(unsigned long sortingRange, std::vector<GapSequence> gapSequences, int iterations)
+// With budgetFactor > 0 gapSequences[0] is the incumbent (previous leader) - on every dataset the others are aborted
+// once their operations exceed budgetFactor times the incumbent's. A censored sequence cannot win that dataset, it is
+// not measured again and is ranked after all fully measured sequences (by its lower-bound mean)
+std::vector<Result> CompareShellsorts(unsigned long sortingRange, std::vector<GapSequence> gapSequences, int iterations, double budgetFactor = 0.0)
 {
     int sortsCount = gapSequences.size();
     std::vector<Result> avgResults(sortsCount);
+    for (int j = 0; j < sortsCount; j++) avgResults[j].gapSequence = gapSequences[j];
 
     for (int i = 0; i < iterations; i++)
     {
         // Get random data for sorting
-        std::vector<int> data = utilis::GetRandomSortingData(sortingRange);
+        std::vector<int> data = utilis::GetSortingDataForIteration(sortingRange, i);
 
         std::vector<Result> results(sortsCount);
+        std::vector<char> measured(sortsCount);
+        for (int j = 0; j < sortsCount; j++) measured[j] = avgResults[j].censored == 0;
+
+        ShellsortBudget budget;
+        int first = 0;
+        if (budgetFactor > 0.0 && sortsCount > 0)
+        {
+            results[0] = MeasureShellsort_Full(data, gapSequences[0]);
+            budget.operations = static_cast<unsigned long>(budgetFactor * results[0].operations);
+            first = 1;
+        }
+
         // Use OpenMP for parallel execution
         #pragma omp parallel for
-        for (int j = 0; j < sortsCount; j++)
+        for (int j = first; j < sortsCount; j++)
         {
-            results[j] = MeasureShellsort_Full(data, gapSequences[j]);
+            if (!measured[j]) continue;
+            results[j] = budgetFactor > 0.0 ? MeasureShellsort_Full(data, gapSequences[j], budget) : MeasureShellsort_Full(data, gapSequences[j]);
         }
 
         // Accumulate results for averaging
-        if (i == 0)
+        for (int j = 0; j < sortsCount; j++)
         {
-            for (int j = 0; j < sortsCount; j++)
-            {
-                avgResults[j] = results[j];
-            }
+            if (!measured[j]) continue;
+            avgResults[j].time += results[j].time;
+            avgResults[j].comparisons += results[j].comparisons;
+            avgResults[j].loops += results[j].loops;
+            avgResults[j].operations += results[j].operations;
+            avgResults[j].moves += results[j].moves;
+            avgResults[j].censored += results[j].censored;
+            avgResults[j].AddHardwareCounters(results[j]);
+            avgResults[j].samples++;
         }
-        else
+
+        // Getting best result for wins count, censored results can not win
+        int winner = -1;
+        for (int j = 0; j < sortsCount; j++)
         {
-            for (int j = 0; j < sortsCount; j++)
-            {
-                avgResults[j].time += results[j].time;
-                avgResults[j].comparisons += results[j].comparisons;
-                avgResults[j].loops += results[j].loops;
-                avgResults[j].operations += results[j].operations;
-            }
+            if (!measured[j] || results[j].censored > 0) continue;
+            if (winner < 0 || results[j].GetFitnessScore() < results[winner].GetFitnessScore()) winner = j;
         }
 
-        // Getting best result for wins count
-        auto winner_it = std::min_element(results.begin(), results.end(), 
-            [](const Result& a, const Result& b) {
-                return a.GetFitnessScore() < b.GetFitnessScore();
-            }
-        );
-        Result winner = *winner_it;
+        if (winner >= 0) for (Result& r : avgResults) if (r.gapSequence == gapSequences[winner]) { r.wins++; }
+    }
 
-        for (Result& r : avgResults) if (r.gapSequence == winner.gapSequence) { r.wins++; }
+    // Average the results over the number of measured samples
+    for (Result& r : avgResults)
+    {
+        double samples = std::max<long>(1, r.samples);
+        r.time = r.time / samples;
+        r.comparisons = r.comparisons / samples;
+        r.loops = r.loops / samples;
+        r.operations = r.operations / samples;
+        r.moves = r.moves / samples;
+        r.DivideHardwareCounters(samples);
+    }
+
+    // Sort results return order by fitness score, censored after fully measured
+    std::sort(avgResults.begin(), avgResults.end(), [](const Result& a, const Result& b) {
+        if ((a.censored > 0) != (b.censored > 0)) return a.censored == 0;
+        return a.GetFitnessScore() < b.GetFitnessScore();
+        });
+
+    return avgResults;
+}
+
+// Bytes carried by one move of the kernel in a records mode
+template <std::size_t PayloadBytes>
+constexpr std::size_t GetRecordMoveBytes(RecordSortMode mode)
+{
+    switch (mode)
+    {
+        case RecordSortMode::Indirect: return sizeof(records::KeyIndex);
+        case RecordSortMode::Pointer: return sizeof(const Record<PayloadBytes>*);
+        case RecordSortMode::KeyPayload: return sizeof(int) + PayloadBytes;
+        default: return sizeof(Record<PayloadBytes>);
+    }
+}
+
+// Records sorted in the given mode, time includes building and applying the permutation of the indirect modes.
+// KeyPayload columns are built before the clock starts - struct of arrays is their native layout
+template <std::size_t PayloadBytes>
+Result MeasureShellsort_Records(const std::vector<int>& keys, GapSequence gapSequence, RecordSortMode mode)
+{
+    std::vector<Record<PayloadBytes>> data = records::GetRecords<PayloadBytes>(keys);
+    records::RecordColumns columns;
+    if (mode == RecordSortMode::KeyPayload) columns = records::GetColumns(data);
+    OperationCounters counter;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if (mode == RecordSortMode::KeyPayload) records::ShellsortKernel_KeyPayload(columns, gapSequence.gaps, counter);
+    else Shellsort_Records(data, gapSequence.gaps, mode, counter);
+    auto stop = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> elapsed = stop - start;
+    Result result{ elapsed.count(), (double)counter.comparisons, (double)counter.loops, (double)counter.GetOperations(), (double)counter.moves, gapSequence };
+    result.elementBytes = GetRecordMoveBytes<PayloadBytes>(mode);
+    return result;
+}
+
+// CompareShellsorts for key+payload records - same datasets as keys, e.g. CompareShellsorts_Records<124>(...) for
+// 128-byte records (4-byte key + 124-byte payload), tuned with --fitness time or movedBytes
+template <std::size_t PayloadBytes>
+std::vector<Result> CompareShellsorts_Records(unsigned long sortingRange, std::vector<GapSequence> gapSequences, int iterations, RecordSortMode mode)
+{
+    int sortsCount = gapSequences.size();
+    std::vector<Result> avgResults(sortsCount);
+    for (int j = 0; j < sortsCount; j++)
+    {
+        avgResults[j].gapSequence = gapSequences[j];
+        avgResults[j].elementBytes = GetRecordMoveBytes<PayloadBytes>(mode);
+    }
+
+    for (int i = 0; i < iterations; i++)
+    {
+        std::vector<int> keys = utilis::GetSortingDataForIteration(sortingRange, i);
+        std::vector<Result> results(sortsCount);
+
+        #pragma omp parallel for
+        for (int j = 0; j < sortsCount; j++)
+        {
+            results[j] = MeasureShellsort_Records<PayloadBytes>(keys, gapSequences[j], mode);
+        }
+
+        for (int j = 0; j < sortsCount; j++)
+        {
+            avgResults[j].time += results[j].time;
+            avgResults[j].comparisons += results[j].comparisons;
+            avgResults[j].loops += results[j].loops;
+            avgResults[j].operations += results[j].operations;
+            avgResults[j].moves += results[j].moves;
+            avgResults[j].samples++;
+        }
+
+        int winner = 0;
+        for (int j = 1; j < sortsCount; j++) if (results[j].GetFitnessScore() < results[winner].GetFitnessScore()) winner = j;
+        if (sortsCount > 0) avgResults[winner].wins++;
     }
 
-    // Average the results over the number of iterations
     for (Result& r : avgResults)
     {
-        r.time = r.time / iterations;
-        r.comparisons = r.comparisons / iterations;
-        r.loops = r.loops / iterations;
-        r.operations = r.operations / iterations;
+        double samples = std::max<long>(1, r.samples);
+        r.time = r.time / samples;
+        r.comparisons = r.comparisons / samples;
+        r.loops = r.loops / samples;
+        r.operations = r.operations / samples;
+        r.moves = r.moves / samples;
     }
 
-    // Sort results return order by fitness score
     std::sort(avgResults.begin(), avgResults.end(), [](const Result& a, const Result& b) {
         return a.GetFitnessScore() < b.GetFitnessScore();
         });
@@ -113,6 +473,92 @@ std::vector<Result> CompareShellsorts(unsigned long sortingRange, std::vector<Ga
     return avgResults;
 }
 
+struct FixedKernelResult
+{
+    GapSequence gapSequence;
+    double runtimeTime = 0.0;
+    double fixedTime = 0.0;
+
+    double GetSpeedup() const
+    {
+        return fixedTime > 0.0 ? runtimeTime / fixedTime : 0.0;
+    }
+};
+
+// Runtime-vector Shellsort against its compile-time kernel on the same data, measured one after another without OpenMP
+std::vector<FixedKernelResult> CompareFixedShellsorts(unsigned long sortingRange, std::vector<std::pair<GapSequence, FixedShellsortKernel>> kernels, int iterations)
+{
+    std::vector<FixedKernelResult> avgResults(kernels.size());
+    for (std::size_t j = 0; j < kernels.size(); j++) avgResults[j].gapSequence = kernels[j].first;
+
+    for (int i = 0; i < iterations; i++)
+    {
+        std::vector<int> data = utilis::GetRandomSortingData(sortingRange);
+
+        for (std::size_t j = 0; j < kernels.size(); j++)
+        {
+            std::vector<int> runtimeData = data;
+            std::vector<int> fixedData = data;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            Shellsort(runtimeData, kernels[j].first.gaps);
+            auto stop = std::chrono::high_resolution_clock::now();
+            avgResults[j].runtimeTime += std::chrono::duration<double, std::milli>(stop - start).count();
+
+            start = std::chrono::high_resolution_clock::now();
+            kernels[j].second(fixedData);
+            stop = std::chrono::high_resolution_clock::now();
+            avgResults[j].fixedTime += std::chrono::duration<double, std::milli>(stop - start).count();
+        }
+    }
+
+    for (FixedKernelResult& r : avgResults)
+    {
+        r.runtimeTime = r.runtimeTime / iterations;
+        r.fixedTime = r.fixedTime / iterations;
+    }
+
+    return avgResults;
+}
+
+struct ScalingResult
+{
+    int threads = 1;
+    double time = 0.0;
+    double speedup = 1.0;
+};
+
+// Single array sorted by Shellsort_Parallel with 1..maxThreads threads, every thread count sorts the same datasets.
+// chunked - Shellsort_ParallelChunked instead, gapSequence is then the sequence for one chunk
+std::vector<ScalingResult> MeasureParallelShellsortScaling(unsigned long sortingRange, GapSequence gapSequence, int maxThreads, int iterations, bool chunked = false)
+{
+    std::vector<ScalingResult> results(maxThreads);
+    for (int t = 0; t < maxThreads; t++) results[t].threads = t + 1;
+
+    for (int i = 0; i < iterations; i++)
+    {
+        std::vector<int> data = utilis::GetRandomSortingData(sortingRange);
+
+        for (ScalingResult& r : results)
+        {
+            std::vector<int> arr = data;
+            auto start = std::chrono::high_resolution_clock::now();
+            if (chunked) Shellsort_ParallelChunked(arr, gapSequence.gaps, r.threads);
+            else Shellsort_Parallel(arr, gapSequence.gaps, r.threads);
+            auto stop = std::chrono::high_resolution_clock::now();
+            r.time += std::chrono::duration<double, std::milli>(stop - start).count();
+        }
+    }
+
+    for (ScalingResult& r : results)
+    {
+        r.time = r.time / iterations;
+        r.speedup = r.time > 0.0 ? results[0].time / r.time : 0.0;
+    }
+
+    return results;
+}
+
 bool IsGapSequenceIn(const GapSequence& sequence, const std::vector<GapSequence>& listOfSequences)
 {
     for (const GapSequence& gs : listOfSequences)
@@ -126,4 +572,9 @@ bool IsGapSequenceIn(const GapSequence& sequence, const std::vector<GapSequence>
 }
 
 
+bool IsGapSequenceIn(const GapSequence& sequence, const GapSequenceSet& setOfSequences)
+{
+    return setOfSequences.find(sequence) != setOfSequences.end();
+}
+
 #endif // !SHELLSORT_COMPARISONS_HPP
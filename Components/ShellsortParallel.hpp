@@ -0,0 +1,271 @@
+#ifndef SHELLSORT_PARALLEL_HPP
+#define SHELLSORT_PARALLEL_HPP
+
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <omp.h>
+#include "Shellsort.hpp"
+
+namespace parallel_shellsort
+{
+    // Gap passes are split across threads while every thread gets at least this many chains
+    unsigned long minimumChainsPerThread = 256;
+    // Chains are handed out in blocks of neighbours so every row of a block shares cache lines
+    unsigned long chainsPerBlock = 64;
+    // Chunks of Shellsort_ParallelChunked, sized to stay in a per-core L2 cache
+    std::size_t chunkBytes = 256 * 1024;
+
+    // Standard h-sorting restricted to chains [c0, c1), rows are visited in order so each chain keeps insertion order
+    inline void HSortChainBlock(int* arr, std::size_t size, std::size_t gap, std::size_t c0, std::size_t c1)
+    {
+        for (std::size_t base = gap; base + c0 < size; base += gap)
+        {
+            const std::size_t rowEnd = std::min(base + c1, size);
+            for (std::size_t i = base + c0; i < rowEnd; i++)
+            {
+                int temp = arr[i];
+                std::size_t j;
+                for (j = i; (j >= gap) && (arr[j - gap] > temp); j -= gap)
+                {
+                    arr[j] = arr[j - gap];
+                }
+                arr[j] = temp;
+            }
+        }
+    }
+
+    // Bottom-up pairwise merging of sorted blocks, merges of each level run in parallel
+    inline void MergeSortedBlocks(std::vector<int>& arr, std::vector<std::size_t> bounds, int threads)
+    {
+        std::vector<int> buffer(arr.size());
+        int* source = arr.data();
+        int* target = buffer.data();
+
+        while (bounds.size() > 2)
+        {
+            const long pairs = static_cast<long>((bounds.size() - 1) / 2);
+            const bool oddBlock = (bounds.size() - 1) % 2 == 1;
+
+            #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+            for (long p = 0; p < pairs; p++)
+            {
+                const std::size_t first = bounds[2 * p], middle = bounds[2 * p + 1], last = bounds[2 * p + 2];
+                std::merge(source + first, source + middle, source + middle, source + last, target + first);
+            }
+            if (oddBlock)
+            {
+                std::copy(source + bounds[bounds.size() - 2], source + bounds.back(), target + bounds[bounds.size() - 2]);
+            }
+
+            std::vector<std::size_t> mergedBounds;
+            for (std::size_t b = 0; b < bounds.size(); b += 2) mergedBounds.push_back(bounds[b]);
+            if (mergedBounds.back() != bounds.back()) mergedBounds.push_back(bounds.back());
+            bounds = mergedBounds;
+            std::swap(source, target);
+        }
+
+        if (source != arr.data()) std::copy(source, source + arr.size(), arr.data());
+    }
+
+    // Tournament tree of losers over sorted runs - the winner is replayed against one node per level, log2(k) comparisons
+    // per output element. Exhausted runs lose every match, ties go to the lower run
+    class LoserTree
+    {
+    public:
+        LoserTree(const std::vector<const int*>& heads, const std::vector<const int*>& ends) : heads(heads), ends(ends)
+        {
+            leaves = 1;
+            while (leaves < heads.size()) leaves *= 2;
+            this->heads.resize(leaves, nullptr);
+            this->ends.resize(leaves, nullptr);
+            tree.assign(leaves, 0);
+            tree[0] = Build(1);
+        }
+
+        int Pop()
+        {
+            std::size_t winner = tree[0];
+            int value = *heads[winner]++;
+            for (std::size_t node = (winner + leaves) / 2; node > 0; node /= 2)
+            {
+                if (Beats(tree[node], winner)) std::swap(tree[node], winner);
+            }
+            tree[0] = winner;
+            return value;
+        }
+
+    private:
+        std::vector<const int*> heads;
+        std::vector<const int*> ends;
+        std::vector<std::size_t> tree; //tree[0] - winner, tree[1..] - loser of every match
+        std::size_t leaves = 1;
+
+        bool Beats(std::size_t a, std::size_t b) const
+        {
+            if (heads[a] == ends[a]) return false;
+            if (heads[b] == ends[b]) return true;
+            return *heads[a] < *heads[b] || (!(*heads[b] < *heads[a]) && a < b);
+        }
+
+        std::size_t Build(std::size_t node)
+        {
+            if (node >= leaves) return node - leaves;
+            std::size_t left = Build(2 * node), right = Build(2 * node + 1);
+            if (Beats(left, right)) { tree[node] = right; return left; }
+            tree[node] = left;
+            return right;
+        }
+    };
+
+    // Split of sorted runs at output rank: positions[c] elements of run c precede the rank. Smallest value v with at least
+    // rank elements <= v is found by binary search over the key range, elements equal to v are taken from the first runs
+    inline std::vector<std::size_t> GetRankSplit(const int* arr, const std::vector<std::size_t>& bounds, std::size_t rank)
+    {
+        const std::size_t runs = bounds.size() - 1;
+        std::int64_t low = std::numeric_limits<int>::min(), high = std::numeric_limits<int>::max();
+        while (low < high)
+        {
+            const std::int64_t middle = low + (high - low) / 2;
+            std::size_t notGreater = 0;
+            for (std::size_t c = 0; c < runs; c++)
+            {
+                notGreater += std::upper_bound(arr + bounds[c], arr + bounds[c + 1], static_cast<int>(middle)) - (arr + bounds[c]);
+            }
+            if (notGreater >= rank) high = middle;
+            else low = middle + 1;
+        }
+
+        std::vector<std::size_t> positions(runs);
+        std::size_t taken = 0;
+        for (std::size_t c = 0; c < runs; c++)
+        {
+            positions[c] = std::lower_bound(arr + bounds[c], arr + bounds[c + 1], static_cast<int>(low)) - (arr + bounds[c]);
+            taken += positions[c];
+        }
+        for (std::size_t c = 0; c < runs && taken < rank; c++)
+        {
+            const std::size_t equal = std::upper_bound(arr + bounds[c] + positions[c], arr + bounds[c + 1], static_cast<int>(low)) - (arr + bounds[c] + positions[c]);
+            const std::size_t take = std::min(equal, rank - taken);
+            positions[c] += take;
+            taken += take;
+        }
+        return positions;
+    }
+
+    // Sorted runs merged in one pass - the output is cut into one part per thread at exact ranks,
+    // every thread merges its part with a loser tree
+    inline void MultiwayMerge(std::vector<int>& arr, const std::vector<std::size_t>& bounds, int threads)
+    {
+        const std::size_t runs = bounds.size() - 1;
+        std::vector<std::vector<std::size_t>> splits(threads + 1);
+        for (int t = 0; t <= threads; t++)
+        {
+            splits[t] = GetRankSplit(arr.data(), bounds, arr.size() * static_cast<std::size_t>(t) / static_cast<std::size_t>(threads));
+        }
+
+        std::vector<int> buffer(arr.size());
+        #pragma omp parallel for num_threads(threads) schedule(static, 1)
+        for (int t = 0; t < threads; t++)
+        {
+            std::vector<const int*> heads(runs), ends(runs);
+            std::size_t output = 0, count = 0;
+            for (std::size_t c = 0; c < runs; c++)
+            {
+                heads[c] = arr.data() + bounds[c] + splits[t][c];
+                ends[c] = arr.data() + bounds[c] + splits[t + 1][c];
+                output += splits[t][c];
+                count += splits[t + 1][c] - splits[t][c];
+            }
+
+            LoserTree tree(heads, ends);
+            for (std::size_t i = 0; i < count; i++) buffer[output + i] = tree.Pop();
+        }
+        arr.swap(buffer);
+    }
+}
+
+// Large gaps: chains of a pass are split across threads. Small gaps: every thread finishes its own block with
+// the remaining gaps and blocks are merged
+void Shellsort_Parallel(std::vector<int>& arr, std::vector<unsigned long>& gaps, int threads = omp_get_max_threads())
+{
+    const std::size_t size = arr.size();
+    if (threads < 1) threads = 1;
+
+    std::size_t g = 0;
+    for (; g < gaps.size(); g++)
+    {
+        const std::size_t gap = gaps[g];
+        if (gap == 0 || gap >= size) continue;
+        if (threads == 1 || gap < static_cast<std::size_t>(threads) * parallel_shellsort::minimumChainsPerThread) break;
+
+        const std::size_t blockWidth = std::max<std::size_t>(1, parallel_shellsort::chainsPerBlock);
+        const long blocks = static_cast<long>((gap + blockWidth - 1) / blockWidth);
+
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+        for (long b = 0; b < blocks; b++)
+        {
+            const std::size_t c0 = static_cast<std::size_t>(b) * blockWidth;
+            parallel_shellsort::HSortChainBlock(arr.data(), size, gap, c0, std::min(c0 + blockWidth, gap));
+        }
+    }
+
+    if (g == gaps.size()) return;
+
+    //Remaining small gaps are run on contiguous blocks, final 1 is enforced so blocks can be merged
+    std::vector<unsigned long> remainingGaps(gaps.begin() + g, gaps.end());
+    if (remainingGaps.back() != 1) remainingGaps.push_back(1);
+
+    if (threads == 1)
+    {
+        Shellsort(arr, remainingGaps);
+        return;
+    }
+
+    std::vector<std::size_t> bounds;
+    for (int t = 0; t <= threads; t++) bounds.push_back(size * static_cast<std::size_t>(t) / static_cast<std::size_t>(threads));
+
+    #pragma omp parallel for num_threads(threads) schedule(static, 1)
+    for (int t = 0; t < threads; t++)
+    {
+        Shellsort(arr.begin() + bounds[t], arr.begin() + bounds[t + 1], remainingGaps);
+    }
+
+    parallel_shellsort::MergeSortedBlocks(arr, bounds, threads);
+}
+
+// Input split into cache-sized chunks, every thread Shellsorts whole chunks with chunkGaps (best known for the chunk
+// size, e.g. hybrid::GetBestBlockGaps(chunkElements)), then a parallel k-way loser tree merge combines them
+void Shellsort_ParallelChunked(std::vector<int>& arr, const std::vector<unsigned long>& chunkGaps, int threads = omp_get_max_threads())
+{
+    const std::size_t size = arr.size();
+    const std::size_t chunkElements = std::max<std::size_t>(1, parallel_shellsort::chunkBytes / sizeof(int));
+    if (threads < 1) threads = 1;
+
+    std::vector<unsigned long> gaps = chunkGaps;
+    if (gaps.empty() || gaps.back() != 1) gaps.push_back(1);
+    if (size <= chunkElements)
+    {
+        Shellsort(arr, gaps);
+        return;
+    }
+
+    std::vector<std::size_t> bounds;
+    for (std::size_t b = 0; b < size; b += chunkElements) bounds.push_back(b);
+    bounds.push_back(size);
+    const long chunks = static_cast<long>(bounds.size() - 1);
+
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+    for (long c = 0; c < chunks; c++)
+    {
+        Shellsort(arr.begin() + bounds[c], arr.begin() + bounds[c + 1], gaps);
+    }
+
+    parallel_shellsort::MultiwayMerge(arr, bounds, threads);
+}
+
+
+#endif // !SHELLSORT_PARALLEL_HPP
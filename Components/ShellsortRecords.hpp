@@ -0,0 +1,200 @@
+#ifndef SHELLSORT_RECORDS_HPP
+#define SHELLSORT_RECORDS_HPP
+
+
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "Shellsort.hpp"
+
+// Record sorted by key, the payload is carried along - a stand-in for production structs
+template <std::size_t PayloadBytes>
+struct Record
+{
+    int key = 0;
+    std::array<unsigned char, PayloadBytes> payload{};
+};
+
+// Direct - records are shifted by the kernel. Indirect - (key, index) pairs are sorted, records gathered once.
+// Pointer - pointers are sorted, key read through the pointer at every comparison, records gathered once.
+// KeyPayload - struct of arrays, keys are compared in their own array and payload moved alongside
+enum class RecordSortMode { Direct, Indirect, Pointer, KeyPayload };
+
+namespace records
+{
+    // Key cached next to the index, so comparisons never touch the records. 32-bit indices keep a pair at 8 bytes,
+    // arrays of more than 2^32 records use KeyIndexWide
+    template <typename Index>
+    struct KeyIndexOf
+    {
+        int key;
+        Index index;
+    };
+
+    using KeyIndex = KeyIndexOf<std::uint32_t>;
+    using KeyIndexWide = KeyIndexOf<std::size_t>;
+
+    // Columns of a records array - keys and fixed size payloads
+    struct RecordColumns
+    {
+        std::vector<int> keys;
+        std::vector<unsigned char> payloads;
+        std::size_t payloadBytes = 0;
+    };
+
+    // Payload filled with copies of the key bytes, so a sorted array can be checked record by record
+    template <std::size_t PayloadBytes>
+    std::vector<Record<PayloadBytes>> GetRecords(const std::vector<int>& keys)
+    {
+        std::vector<Record<PayloadBytes>> data(keys.size());
+        for (std::size_t i = 0; i < keys.size(); i++)
+        {
+            data[i].key = keys[i];
+            for (std::size_t b = 0; b < PayloadBytes; b++) data[i].payload[b] = static_cast<unsigned char>(keys[i] >> (8 * (b % sizeof(int))));
+        }
+        return data;
+    }
+
+    template <std::size_t PayloadBytes>
+    RecordColumns GetColumns(const std::vector<Record<PayloadBytes>>& data)
+    {
+        RecordColumns columns{ std::vector<int>(data.size()), std::vector<unsigned char>(data.size() * PayloadBytes), PayloadBytes };
+        for (std::size_t i = 0; i < data.size(); i++)
+        {
+            columns.keys[i] = data[i].key;
+            std::memcpy(columns.payloads.data() + i * PayloadBytes, data[i].payload.data(), PayloadBytes);
+        }
+        return columns;
+    }
+
+    template <std::size_t PayloadBytes>
+    void SetFromColumns(std::vector<Record<PayloadBytes>>& data, const RecordColumns& columns)
+    {
+        for (std::size_t i = 0; i < data.size(); i++)
+        {
+            data[i].key = columns.keys[i];
+            std::memcpy(data[i].payload.data(), columns.payloads.data() + i * PayloadBytes, PayloadBytes);
+        }
+    }
+
+    // data[i] = old data[order[i]], every record is moved once through a buffer
+    template <typename T, typename IndexOf>
+    void Gather(std::vector<T>& data, std::size_t size, IndexOf indexOf)
+    {
+        std::vector<T> sorted;
+        sorted.reserve(size);
+        for (std::size_t i = 0; i < size; i++) sorted.push_back(std::move(data[indexOf(i)]));
+        data = std::move(sorted);
+    }
+
+    // (key, index) pairs sorted, then records gathered once in key order
+    template <typename Index, typename Record, typename Counter>
+    void SortIndirect(std::vector<Record>& data, const std::vector<unsigned long>& gaps, Counter& counter)
+    {
+        std::less<> comp;
+        std::vector<KeyIndexOf<Index>> order(data.size());
+        for (std::size_t i = 0; i < data.size(); i++) order[i] = { data[i].key, static_cast<Index>(i) };
+        auto proj = &KeyIndexOf<Index>::key;
+        ShellsortKernel(order.begin(), order.end(), gaps, comp, proj, counter);
+        Gather(data, order.size(), [&](std::size_t i) { return order[i].index; });
+    }
+
+    // h-sorting pass over columns, the same counter events as HSortPass - a move shifts a key and its payload
+    template <typename Counter>
+    void HSortPass_KeyPayload(RecordColumns& columns, std::size_t gap, std::vector<unsigned char>& temp, Counter& counter)
+    {
+        counter.Pass();
+        const std::size_t size = columns.keys.size();
+        const std::size_t bytes = columns.payloadBytes;
+        if (gap == 0 || gap >= size) return;
+
+        int* keys = columns.keys.data();
+        unsigned char* payloads = columns.payloads.data();
+        for (std::size_t i = gap; i < size; i++)
+        {
+            if (counter.ShouldAbort()) return;
+            counter.Insertion();
+            const int key = keys[i];
+            std::size_t j = i;
+            while (j >= gap)
+            {
+                counter.Comparison();
+                if (!(key < keys[j - gap])) break;
+                if (j == i) std::memcpy(temp.data(), payloads + i * bytes, bytes);
+
+                keys[j] = keys[j - gap];
+                std::memcpy(payloads + j * bytes, payloads + (j - gap) * bytes, bytes);
+                j -= gap;
+                counter.Shift();
+            }
+            if (j != i)
+            {
+                keys[j] = key;
+                std::memcpy(payloads + j * bytes, temp.data(), bytes);
+            }
+            counter.Placement();
+        }
+    }
+
+    template <typename Counter>
+    void ShellsortKernel_KeyPayload(RecordColumns& columns, const std::vector<unsigned long>& gaps, Counter& counter)
+    {
+        std::vector<unsigned char> temp(columns.payloadBytes);
+        for (unsigned long gap : gaps)
+        {
+            if (counter.ShouldAbort()) return;
+            HSortPass_KeyPayload(columns, gap, temp, counter);
+        }
+    }
+}
+
+// Records sorted by key in the given mode, counters see the kernel only (building and gathering are not counted)
+template <std::size_t PayloadBytes, typename Counter>
+void Shellsort_Records(std::vector<Record<PayloadBytes>>& data, const std::vector<unsigned long>& gaps, RecordSortMode mode, Counter& counter)
+{
+    std::less<> comp;
+    switch (mode)
+    {
+        case RecordSortMode::Indirect:
+        {
+            if (data.size() <= std::numeric_limits<std::uint32_t>::max()) records::SortIndirect<std::uint32_t>(data, gaps, counter);
+            else records::SortIndirect<std::size_t>(data, gaps, counter);
+            break;
+        }
+        case RecordSortMode::Pointer:
+        {
+            std::vector<const Record<PayloadBytes>*> pointers(data.size());
+            for (std::size_t i = 0; i < data.size(); i++) pointers[i] = &data[i];
+            auto proj = [](const Record<PayloadBytes>* record) { return record->key; };
+            ShellsortKernel(pointers.begin(), pointers.end(), gaps, comp, proj, counter);
+            records::Gather(data, pointers.size(), [&](std::size_t i) { return pointers[i] - data.data(); });
+            break;
+        }
+        case RecordSortMode::KeyPayload:
+        {
+            records::RecordColumns columns = records::GetColumns(data);
+            records::ShellsortKernel_KeyPayload(columns, gaps, counter);
+            records::SetFromColumns(data, columns);
+            break;
+        }
+        default:
+        {
+            auto proj = &Record<PayloadBytes>::key;
+            ShellsortKernel(data.begin(), data.end(), gaps, comp, proj, counter);
+            break;
+        }
+    }
+}
+
+template <std::size_t PayloadBytes>
+void Shellsort_Records(std::vector<Record<PayloadBytes>>& data, const std::vector<unsigned long>& gaps, RecordSortMode mode)
+{
+    NoCounters counter;
+    Shellsort_Records(data, gaps, mode, counter);
+}
+
+
+#endif // !SHELLSORT_RECORDS_HPP
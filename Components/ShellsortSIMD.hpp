@@ -0,0 +1,221 @@
+#ifndef SHELLSORT_SIMD_HPP
+#define SHELLSORT_SIMD_HPP
+
+
+#include <iostream>
+#include <vector>
+#include <cstddef>
+#include "Shellsort.hpp"
+#include "Utilis.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SHELLSORT_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace simd
+{
+    // Scalar insertion of a single element into its chain, used for tails and small gaps
+    inline void InsertIntoChain(int* arr, std::size_t i, std::size_t gap)
+    {
+        int temp = arr[i];
+        std::size_t j;
+        for (j = i; (j >= gap) && (arr[j - gap] > temp); j -= gap)
+        {
+            arr[j] = arr[j - gap];
+        }
+        arr[j] = temp;
+    }
+
+    // Boundary step of a vector pass: lane k (element temps[k], hole at j + k) either reached its chain start or still
+    // has a predecessor at j + k - gap, in which case its insertion is finished by scalar code
+    inline void FinishLanes(int* arr, std::size_t j, std::size_t gap, const int* temps, unsigned activeLanes, std::size_t lanes)
+    {
+        for (std::size_t k = 0; k < lanes; k++)
+        {
+            if (!(activeLanes & (1u << k))) continue;
+            const int temp = temps[k];
+            std::size_t p = j + k;
+            for (; (p >= gap) && (arr[p - gap] > temp); p -= gap)
+            {
+                arr[p] = arr[p - gap];
+            }
+            arr[p] = temp;
+        }
+    }
+
+#ifdef SHELLSORT_SIMD_X86
+    // 8 neighbouring chains are h-sorted at once, lane k works on chain (i + k) % gap, requires gap >= 8
+    __attribute__((target("avx2")))
+    inline void HSortPass_AVX2(int* arr, std::size_t size, std::size_t gap)
+    {
+        std::size_t i = gap;
+        for (; i + 8 <= size; i += 8)
+        {
+            const __m256i temp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(arr + i));
+            __m256i active = _mm256_set1_epi32(-1);
+            std::size_t j = i;
+
+            while (true)
+            {
+                if (j < gap)
+                {
+                    //Lane 0 reached its chain start, lanes with j + k >= gap have not
+                    alignas(32) int temps[8];
+                    _mm256_store_si256(reinterpret_cast<__m256i*>(temps), temp);
+                    FinishLanes(arr, j, gap, temps, static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(active))), 8);
+                    break;
+                }
+
+                __m256i prev = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(arr + j - gap));
+                __m256i greater = _mm256_and_si256(_mm256_cmpgt_epi32(prev, temp), active);
+                __m256i stopping = _mm256_andnot_si256(greater, active);
+
+                //Shifting lanes take previous element, stopping lanes take temp, finished lanes keep current value
+                __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(arr + j));
+                __m256i out = _mm256_blendv_epi8(current, prev, greater);
+                out = _mm256_blendv_epi8(out, temp, stopping);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(arr + j), out);
+
+                active = greater;
+                if (_mm256_testz_si256(active, active)) break;
+                j -= gap;
+            }
+        }
+
+        for (; i < size; i++) InsertIntoChain(arr, i, gap);
+    }
+
+    // 16 neighbouring chains with mask registers, requires gap >= 16
+    __attribute__((target("avx512f")))
+    inline void HSortPass_AVX512(int* arr, std::size_t size, std::size_t gap)
+    {
+        std::size_t i = gap;
+        for (; i + 16 <= size; i += 16)
+        {
+            const __m512i temp = _mm512_loadu_si512(arr + i);
+            __mmask16 active = 0xFFFF;
+            std::size_t j = i;
+
+            while (true)
+            {
+                if (j < gap)
+                {
+                    alignas(64) int temps[16];
+                    _mm512_store_si512(temps, temp);
+                    FinishLanes(arr, j, gap, temps, static_cast<unsigned>(active), 16);
+                    break;
+                }
+
+                __m512i prev = _mm512_loadu_si512(arr + j - gap);
+                __mmask16 greater = _mm512_mask_cmpgt_epi32_mask(active, prev, temp);
+                __mmask16 stopping = active & static_cast<__mmask16>(~greater);
+
+                _mm512_mask_storeu_epi32(arr + j, greater, prev);
+                _mm512_mask_storeu_epi32(arr + j, stopping, temp);
+
+                active = greater;
+                if (active == 0) break;
+                j -= gap;
+            }
+        }
+
+        for (; i < size; i++) InsertIntoChain(arr, i, gap);
+    }
+#endif
+
+    enum class InstructionSet { Scalar, AVX2, AVX512 };
+
+    inline InstructionSet GetSupportedInstructionSet()
+    {
+#ifdef SHELLSORT_SIMD_X86
+        static const InstructionSet supported = []() {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) return InstructionSet::AVX512;
+            if (__builtin_cpu_supports("avx2")) return InstructionSet::AVX2;
+            return InstructionSet::Scalar;
+        }();
+        return supported;
+#else
+        return InstructionSet::Scalar;
+#endif
+    }
+
+    inline const char* GetInstructionSetName(InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+            case InstructionSet::AVX512: return "AVX-512";
+            case InstructionSet::AVX2: return "AVX2";
+            default: return "scalar";
+        }
+    }
+
+    inline std::size_t GetLanesCount(InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+            case InstructionSet::AVX512: return 16;
+            case InstructionSet::AVX2: return 8;
+            default: return 1;
+        }
+    }
+
+    // Single h-sorting pass, vectorized for gaps >= minimumGap (at least the lanes count), scalar otherwise
+    inline void HSortPass(std::vector<int>& arr, std::size_t gap, std::size_t minimumGap, InstructionSet instructionSet)
+    {
+        const std::size_t lanes = GetLanesCount(instructionSet);
+        if (gap == 0 || gap >= arr.size()) return;
+
+        if (lanes == 1 || gap == 1 || gap < std::max(minimumGap, lanes))
+        {
+            for (std::size_t i = gap; i < arr.size(); i++) InsertIntoChain(arr.data(), i, gap);
+            return;
+        }
+
+#ifdef SHELLSORT_SIMD_X86
+        if (instructionSet == InstructionSet::AVX512) HSortPass_AVX512(arr.data(), arr.size(), gap);
+        else HSortPass_AVX2(arr.data(), arr.size(), gap);
+#endif
+    }
+
+    inline bool IsHSorted(const std::vector<int>& arr, std::size_t gap)
+    {
+        for (std::size_t i = gap; i < arr.size(); i++) if (arr[i - gap] > arr[i]) return false;
+        return true;
+    }
+
+    // Every vector pass checked against the scalar pass on the same input - both must leave identical, h-sorted arrays,
+    // so SIMD timings measure the same algorithm. Vector passes are used for every gap of at least the lanes count
+    bool VerifyPasses(unsigned long sortingRange, const std::vector<unsigned long>& gaps, int iterations, InstructionSet instructionSet = GetSupportedInstructionSet())
+    {
+        for (int it = 0; it < iterations; it++)
+        {
+            std::vector<int> vectorized = utilis::GetRandomSortingData(sortingRange);
+            std::vector<int> scalar = vectorized;
+            for (unsigned long gap : gaps)
+            {
+                HSortPass(vectorized, gap, 0, instructionSet);
+                HSortPass(scalar, gap, 0, InstructionSet::Scalar);
+                if (gap == 0 || gap >= sortingRange) continue;
+
+                if (!IsHSorted(vectorized, gap) || vectorized != scalar)
+                {
+                    std::cerr << "ERROR: " << GetInstructionSetName(instructionSet) << " pass differs from scalar pass, n = " << sortingRange << ", gap = " << gap << std::endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+// Shellsort with vectorized multi-chain passes for gaps >= simdMinimumGap, smaller gaps and final h=1 pass stay scalar
+void Shellsort_SIMD(std::vector<int>& arr, std::vector<unsigned long>& gaps, unsigned long simdMinimumGap = 16,
+    simd::InstructionSet instructionSet = simd::GetSupportedInstructionSet())
+{
+    for (unsigned long gap : gaps) simd::HSortPass(arr, gap, simdMinimumGap, instructionSet);
+}
+
+
+#endif // !SHELLSORT_SIMD_HPP
@@ -0,0 +1,264 @@
+#ifndef TIMING_HARNESS_HPP
+#define TIMING_HARNESS_HPP
+
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <sched.h>
+#include "Shellsort.hpp"
+#include "ShellsortComparisons.hpp"
+#include "Utilis.hpp"
+
+// Isolated wall-clock measurement - one pinned thread, warm-up, interleaved repetitions and robust statistics,
+// so time does not depend on what other OpenMP threads are sorting at the same moment
+namespace timing
+{
+    struct TimingOptions
+    {
+        int cpu = -1; //CPU the measuring thread is pinned to, -1 - the CPU it is running on
+        int warmUpRuns = 3; //untimed sorts of every sequence before measuring
+        int repetitions = 5; //timed sorts of every sequence per dataset, the dataset value is their median
+        double confidence = 0.95;
+        double driftTolerance = 0.05; //relative change of the reference loop that marks a frequency change
+        int maxRetries = 3; //re-measurements of a dataset disturbed by a frequency change
+    };
+
+    struct TimingStats
+    {
+        double median = 0.0;
+        double mad = 0.0; //median absolute deviation, scaled to estimate the standard deviation
+        double lower = 0.0; //distribution-free confidence interval of the median
+        double upper = 0.0;
+    };
+
+    double GetMedian(std::vector<double> values)
+    {
+        if (values.empty()) return 0.0;
+        std::size_t middle = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + middle, values.end());
+        double median = values[middle];
+        if (values.size() % 2 == 0) median = (median + *std::max_element(values.begin(), values.begin() + middle)) / 2.0;
+        return median;
+    }
+
+    TimingStats GetTimingStats(std::vector<double> values, double confidence)
+    {
+        TimingStats stats;
+        if (values.empty()) return stats;
+
+        stats.median = GetMedian(values);
+        std::vector<double> deviations(values.size());
+        for (std::size_t k = 0; k < values.size(); k++) deviations[k] = std::abs(values[k] - stats.median);
+        stats.mad = 1.4826 * GetMedian(deviations);
+
+        //Order statistics around n/2 from the normal approximation of Binomial(n, 1/2)
+        std::sort(values.begin(), values.end());
+        double n = static_cast<double>(values.size());
+        double halfWidth = utilis::GetNormalQuantile(0.5 + confidence / 2.0) * std::sqrt(n) / 2.0;
+        long lowerRank = static_cast<long>(std::floor(n / 2.0 - halfWidth));
+        long upperRank = static_cast<long>(std::ceil(n / 2.0 + halfWidth)) - 1;
+        stats.lower = values[std::clamp<long>(lowerRank, 0, values.size() - 1)];
+        stats.upper = values[std::clamp<long>(upperRank, 0, values.size() - 1)];
+        return stats;
+    }
+
+    // Fixed dependent integer loop, its duration follows the core frequency
+    double MeasureReferenceLoop()
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t x = 0;
+        for (int k = 0; k < 200000; k++) x = utilis::SplitMix64(x);
+        auto stop = std::chrono::steady_clock::now();
+
+        volatile std::uint64_t sink = x;
+        (void)sink;
+        return std::chrono::duration<double, std::milli>(stop - start).count();
+    }
+
+    // Spins until two consecutive reference loops agree, so turbo / power states have settled, returns the last one
+    double WaitForStableFrequency(double tolerance)
+    {
+        double previous = MeasureReferenceLoop();
+        for (int k = 0; k < 500; k++)
+        {
+            double current = MeasureReferenceLoop();
+            if (std::abs(current - previous) <= tolerance * previous) return current;
+            previous = current;
+        }
+        return previous;
+    }
+
+    void WarnAboutGovernor(int cpu)
+    {
+        std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/scaling_governor");
+        std::string governor;
+        if (file >> governor && governor != "performance")
+        {
+            std::cerr << "WARNING: CPU " << cpu << " uses the '" << governor << "' frequency governor, timings may drift (use 'performance')" << std::endl;
+        }
+    }
+
+    // Pins the calling thread to one CPU for its lifetime and restores the previous affinity afterwards
+    class ThreadPin
+    {
+        public:
+        ThreadPin(int cpu)
+        {
+            hasPrevious = sched_getaffinity(0, sizeof(previous), &previous) == 0;
+            this->cpu = cpu >= 0 ? cpu : sched_getcpu();
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(this->cpu, &set);
+            if (sched_setaffinity(0, sizeof(set), &set) != 0) std::cerr << "WARNING: Could not pin the timing thread to CPU " << this->cpu << std::endl;
+        }
+
+        ~ThreadPin()
+        {
+            if (hasPrevious) sched_setaffinity(0, sizeof(previous), &previous);
+        }
+
+        ThreadPin(const ThreadPin&) = delete;
+        ThreadPin& operator=(const ThreadPin&) = delete;
+
+        int GetCpu() const { return cpu; }
+
+        private:
+        int cpu = 0;
+        cpu_set_t previous;
+        bool hasPrevious = false;
+    };
+
+    enum class SearchTiming { Auto, Parallel, Isolated };
+
+    const char* const SEARCH_TIMING_NAMES[] = { "auto", "parallel", "isolated" };
+
+    // How the searches measure time - Parallel keeps the cached multi-threaded evaluation, Isolated evaluates every
+    // population with CompareShellsorts_Timed, Auto isolates whenever time is part of the fitness function
+    SearchTiming searchTiming = SearchTiming::Auto;
+
+    bool ParseSearchTiming(const std::string& name, SearchTiming& timing)
+    {
+        for (int t = 0; t < 3; t++)
+        {
+            if (name == SEARCH_TIMING_NAMES[t]) { timing = static_cast<SearchTiming>(t); return true; }
+        }
+        return false;
+    }
+
+    // Extra objectives are those ranked besides the fitness function, e.g. Pareto objectives
+    bool IsSearchTimingIsolated(const std::vector<FitnessObjective>& objectives = {})
+    {
+        if (searchTiming != SearchTiming::Auto) return searchTiming == SearchTiming::Isolated;
+        return fitnessFunction.Uses(FitnessObjective::Time)
+            || std::find(objectives.begin(), objectives.end(), FitnessObjective::Time) != objectives.end();
+    }
+
+    double TimeSort(const std::vector<int>& data, std::vector<unsigned long>& gaps)
+    {
+        std::vector<int> arr = data;
+        auto start = std::chrono::steady_clock::now();
+        Shellsort(arr, gaps);
+        auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(stop - start).count();
+    }
+}
+
+// CompareShellsorts with time measured in isolation: every dataset is sorted by all sequences in a shuffled,
+// interleaved order on one pinned thread, repetitions disturbed by a frequency change are measured again.
+// time is the median over datasets with timeMad and timeConfidenceInterval, counts are means as usual
+std::vector<Result> CompareShellsorts_Timed(unsigned long sortingRange, std::vector<GapSequence> gapSequences, int iterations, timing::TimingOptions options = {})
+{
+    int sortsCount = gapSequences.size();
+    std::vector<Result> avgResults(sortsCount);
+    std::vector<std::vector<double>> times(sortsCount);
+    for (int j = 0; j < sortsCount; j++) avgResults[j].gapSequence = gapSequences[j];
+
+    timing::ThreadPin pin(options.cpu);
+    timing::WarnAboutGovernor(pin.GetCpu());
+    double reference = timing::WaitForStableFrequency(options.driftTolerance);
+    int drifts = 0;
+
+    std::vector<int> order(sortsCount);
+    for (int j = 0; j < sortsCount; j++) order[j] = j;
+
+    for (int i = 0; i < iterations; i++)
+    {
+        // Get random data for sorting
+        std::vector<int> data = utilis::GetSortingDataForIteration(sortingRange, i);
+
+        for (int w = 0; w < (i == 0 ? options.warmUpRuns : 0); w++)
+        {
+            for (int j : order) timing::TimeSort(data, gapSequences[j].gaps);
+        }
+
+        std::vector<std::vector<double>> repetitions;
+        for (int attempt = 0; attempt <= options.maxRetries; attempt++)
+        {
+            repetitions.assign(sortsCount, std::vector<double>());
+            for (int r = 0; r < options.repetitions; r++)
+            {
+                std::shuffle(order.begin(), order.end(), utilis::GetThreadGenerator());
+                for (int j : order) repetitions[j].push_back(timing::TimeSort(data, gapSequences[j].gaps));
+            }
+
+            double current = timing::MeasureReferenceLoop();
+            if (std::abs(current - reference) <= options.driftTolerance * reference) break;
+
+            drifts++;
+            reference = timing::WaitForStableFrequency(options.driftTolerance);
+        }
+
+        std::vector<Result> results(sortsCount);
+        for (int j = 0; j < sortsCount; j++)
+        {
+            results[j] = MeasureShellsort_Full(data, gapSequences[j]);
+            results[j].time = timing::GetMedian(repetitions[j]);
+            times[j].push_back(results[j].time);
+
+            avgResults[j].comparisons += results[j].comparisons;
+            avgResults[j].loops += results[j].loops;
+            avgResults[j].operations += results[j].operations;
+            avgResults[j].moves += results[j].moves;
+            avgResults[j].AddHardwareCounters(results[j]);
+            avgResults[j].samples++;
+        }
+
+        // Getting best result for wins count
+        int winner = 0;
+        for (int j = 1; j < sortsCount; j++) if (results[j].GetFitnessScore() < results[winner].GetFitnessScore()) winner = j;
+        if (sortsCount > 0) for (Result& r : avgResults) if (r.gapSequence == gapSequences[winner]) { r.wins++; }
+    }
+
+    if (drifts > 0) std::cerr << "WARNING: Frequency changed " << drifts << " times during timing, affected datasets were measured again" << std::endl;
+
+    for (int j = 0; j < sortsCount; j++)
+    {
+        Result& r = avgResults[j];
+        double samples = std::max<long>(1, r.samples);
+        timing::TimingStats stats = timing::GetTimingStats(times[j], options.confidence);
+        r.time = stats.median;
+        r.timeMad = stats.mad;
+        r.timeConfidenceInterval = (stats.upper - stats.lower) / 2.0;
+        r.comparisons = r.comparisons / samples;
+        r.loops = r.loops / samples;
+        r.operations = r.operations / samples;
+        r.moves = r.moves / samples;
+        r.DivideHardwareCounters(samples);
+    }
+
+    // Sort results return order by fitness score
+    std::sort(avgResults.begin(), avgResults.end(), [](const Result& a, const Result& b) {
+        return a.GetFitnessScore() < b.GetFitnessScore();
+        });
+
+    return avgResults;
+}
+
+
+#endif // !TIMING_HARNESS_HPP
@@ -4,60 +4,211 @@
 #include <iostream>
 #include <random>
 #include <vector>
+#include <array>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <charconv>
 #include <omp.h>
+#include "InputDistributions.hpp"
 
 namespace utilis
 {
+    // SplitMix64 finalizer - used for seeding and as counter-based generator for datasets
+    inline std::uint64_t SplitMix64(std::uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    // xoshiro256** generator, usable with std distributions
+    class Xoshiro256
+    {
+        public:
+        using result_type = std::uint64_t;
+        std::array<std::uint64_t, 4> state;
+
+        explicit Xoshiro256(std::uint64_t seed = 0) { Seed(seed); }
+
+        void Seed(std::uint64_t seed)
+        {
+            for (std::uint64_t& s : state) { seed = SplitMix64(seed); s = seed; }
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return UINT64_MAX; }
+
+        result_type operator()()
+        {
+            const std::uint64_t result = Rotl(state[1] * 5, 7) * 9;
+            const std::uint64_t t = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = Rotl(state[3], 45);
+            return result;
+        }
+
+        private:
+        static std::uint64_t Rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    };
+
+    // Run seed - every random decision and dataset is derived from it, so a run is reproducible from its seed
+    std::uint64_t runSeed = (static_cast<std::uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}();
+    std::atomic<std::uint64_t> runSeedEpoch{ 0 };
+    std::atomic<std::uint64_t> datasetCounter{ 0 };
+    // Common random numbers - iteration i of every comparison sorts the same dataset, across generations too
+    bool commonRandomNumbers = false;
+
+    // Input distributions datasets are drawn from, every dataset follows one component picked by weight (empty - uniform)
+    std::vector<distributions::Distribution> inputMixture;
+
+    // Stream of the calling thread, threads that need reproducible random numbers (islands) set their own.
+    // Other threads get a unique stream of their own on first use, above FALLBACK_STREAM_OFFSET
+    thread_local long threadStream = -1;
+    const long FALLBACK_STREAM_OFFSET = 1L << 40;
+    std::atomic<long> fallbackStreamsCount{ 0 };
+
+    std::uint64_t GetRunSeed() { return runSeed; }
+
+    void SetRunSeed(std::uint64_t seed)
+    {
+        runSeed = seed;
+        datasetCounter = 0;
+        runSeedEpoch++;
+    }
+
+    void SetThreadStream(long stream) { threadStream = stream; }
+
+    std::uint64_t GetStreamSeed(std::uint64_t stream, std::uint64_t index = 0)
+    {
+        return SplitMix64(SplitMix64(runSeed ^ SplitMix64(stream)) + index);
+    }
+
+    // Generator of the calling thread's stream, every stream is seeded once per run seed and continues where it stopped
+    // when the thread switches back to it - streams are never shared between threads, so sequences never repeat
+    Xoshiro256& GetThreadGenerator()
+    {
+        thread_local static const long fallbackStream = FALLBACK_STREAM_OFFSET + fallbackStreamsCount++;
+        thread_local static std::unordered_map<long, Xoshiro256> generators;
+        thread_local static std::uint64_t epoch = UINT64_MAX;
+        thread_local static long stream = -2;
+        thread_local static Xoshiro256* gen = nullptr;
+
+        const long currentStream = threadStream >= 0 ? threadStream : fallbackStream;
+        if (epoch != runSeedEpoch.load())
+        {
+            epoch = runSeedEpoch.load();
+            generators.clear();
+            stream = -2;
+        }
+        if (stream != currentStream)
+        {
+            stream = currentStream;
+            auto it = generators.find(currentStream);
+            if (it == generators.end()) it = generators.emplace(currentStream, Xoshiro256(GetStreamSeed(static_cast<std::uint64_t>(currentStream)))).first;
+            gen = &it->second;
+        }
+        return *gen;
+    }
+
     float GetRandomFloat(float min, float max)
     {
-        thread_local static std::random_device rd;
-        thread_local static std::mt19937 gen(rd());
         std::uniform_real_distribution<float> dist(min, max);
-        return dist(gen);
+        return dist(GetThreadGenerator());
     }
 
     double GetRandomDouble(double min, double max)
     {
-        thread_local static std::random_device rd;
-        thread_local static std::mt19937 gen(rd());
         std::uniform_real_distribution<double> dist(min, max);
-        return dist(gen);
+        return dist(GetThreadGenerator());
     }
 
     int GetRandomInt(int min, int max)
     {
-        thread_local static std::random_device rd;
-        thread_local static std::mt19937 gen(rd());
         std::uniform_int_distribution<int> dist(min, max);
-        return dist(gen);
+        return dist(GetThreadGenerator());
     }
 
-    std::vector<int> GetRandomSortingData(unsigned long sortingRange)
+    // Dataset is a pure function of (run seed, sortingRange, dataset index), independent of threads count
+    std::vector<int> GetSortingData(unsigned long sortingRange, std::uint64_t datasetIndex)
     {
         std::vector<int> data(sortingRange);
+        const std::uint64_t seed = GetStreamSeed(0xDA7A5E7ULL ^ (static_cast<std::uint64_t>(sortingRange) << 20), datasetIndex);
 
-        #pragma omp parallel
-        {
-            std::random_device rd;
-            std::mt19937 gen(rd() ^ static_cast<unsigned int>(omp_get_thread_num()));
-            std::uniform_int_distribution<int> dist(-10000, 10000);
-
-            #pragma omp for
-            for (std::size_t i = 0; i < data.size(); ++i)
-            {
-                data[i] = dist(gen);
-            }
-        }
+        //Uniform in [-10000, 10000] unless a mixture is set
+        static const distributions::Distribution uniform;
+        const distributions::Distribution& distribution = inputMixture.empty() ? uniform : distributions::PickFromMixture(inputMixture, SplitMix64(~seed));
+        distributions::Generate(data, distribution, [seed](std::uint64_t k) { return SplitMix64(seed + k); });
 
         return data;
     }
 
+    std::vector<int> GetRandomSortingData(unsigned long sortingRange)
+    {
+        return GetSortingData(sortingRange, datasetCounter++ | (1ULL << 63));
+    }
+
+    // Dataset index for iteration of a comparison - shared across generations with common random numbers, fresh otherwise
+    std::uint64_t GetDatasetIndexForIteration(std::uint64_t iteration)
+    {
+        if (commonRandomNumbers) return iteration;
+        return datasetCounter++ | (1ULL << 63);
+    }
+
+    std::vector<int> GetSortingDataForIteration(unsigned long sortingRange, std::uint64_t iteration)
+    {
+        return GetSortingData(sortingRange, GetDatasetIndexForIteration(iteration));
+    }
+
     double GetNormalDistribution(double mean, double stddev)
     {
-        thread_local static std::random_device rd;
-        thread_local static std::mt19937 gen(rd());
         std::normal_distribution<double> dist(mean, stddev);
-        return dist(gen);
+        return dist(GetThreadGenerator());
+    }
+
+    // Inverse of standard normal CDF, Acklam's rational approximation (relative error below 1.2e-9)
+    double GetNormalQuantile(double p)
+    {
+        static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+        static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+        static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+        static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00 };
+        const double pLow = 0.02425;
+
+        if (p <= 0.0) return -INFINITY;
+        if (p >= 1.0) return INFINITY;
+
+        if (p < pLow || p > 1.0 - pLow)
+        {
+            double q = std::sqrt(-2.0 * std::log(p < pLow ? p : 1.0 - p));
+            double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+            return p < pLow ? x : -x;
+        }
+
+        double q = p - 0.5;
+        double r = q * q;
+        return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    }
+
+    // Student t quantile - exact for 1 and 2 degrees of freedom, Cornish-Fisher expansion above
+    double GetStudentTQuantile(double p, long degreesOfFreedom)
+    {
+        if (degreesOfFreedom < 1) return INFINITY;
+        if (degreesOfFreedom == 1) return std::tan(M_PI * (p - 0.5));
+        if (degreesOfFreedom == 2) return (2.0 * p - 1.0) / std::sqrt(2.0 * p * (1.0 - p));
+
+        const double z = GetNormalQuantile(p);
+        const double v = static_cast<double>(degreesOfFreedom);
+        const double z3 = z * z * z, z5 = z3 * z * z, z7 = z5 * z * z;
+        return z + (z3 + z) / (4.0 * v) + (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * v * v)
+            + (3.0 * z7 + 19.0 * z5 + 17.0 * z3 - 15.0 * z) / (384.0 * v * v * v);
     }
 
     int RoundUpToOdd(int number)
@@ -70,6 +221,23 @@ namespace utilis
         return (number % 2 != 0) ? number + 1 : number;
     }   
 
+    // Arrays of arrayBytes that fit memoryBudget next to the dataset they are copied from (0 - not even one)
+    std::size_t GetConcurrentCopies(std::size_t arrayBytes, std::size_t memoryBudget)
+    {
+        if (arrayBytes == 0) return SIZE_MAX;
+        return memoryBudget / arrayBytes > 0 ? memoryBudget / arrayBytes - 1 : 0;
+    }
+
+    // Whole text as a positive count, false on anything else (sign, trailing characters, overflow)
+    bool ParseCount(const std::string& text, unsigned long& value)
+    {
+        unsigned long parsed = 0;
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), parsed);
+        if (result.ec != std::errc() || result.ptr != text.data() + text.size() || parsed == 0) return false;
+        value = parsed;
+        return true;
+    }
+
     std::vector<std::string> SplitString(std::string toSplit, const std::string& spliter)
     {
         std::vector<std::string> tokens;
@@ -1,6 +1,7 @@
 ﻿#include <iostream>
 #include <vector>
 #include <fstream>
+#include <climits>
 #include "Components/SearchingAlgorithms/GeneticAlgorithm_v1.hpp"
 #include "Components/SearchingAlgorithms/GeneticAlgorithm_v2.hpp"
 #include "Components/SearchingAlgorithms/GeneticAlgorithm_v3.hpp"
@@ -8,9 +9,16 @@
 #include "Components/SearchingAlgorithms/GeneticAlgorithm_v5.hpp"
 #include "Components/SearchingAlgorithms/CuckooSearch.hpp"
 #include "Components/SearchingAlgorithms/ArtificialBeeColony.hpp"
+#include "Components/SearchingAlgorithms/IslandModel.hpp"
 #include "Components/Shellsort.hpp"
 #include "Components/ShellsortComparisons.hpp"
 #include "Components/FilesManagement.hpp"
+#include "Components/DistributedEvaluation.hpp"
+#include "Components/CandidateStore.hpp"
+#include "Components/TimingHarness.hpp"
+#include "Components/ScalingSweep.hpp"
+#include "Components/GapExtrapolation.hpp"
+#include "Components/HybridSort.hpp"
 #include "omp.h"
 
 const unsigned long SORTING_RANGE = 1000; 
@@ -23,13 +31,150 @@ void PrintResults(std::vector<Result>& results, int topN = 10)
         auto& r = results[i];
         r.gapSequence.PrintInstance();
         std::cout << "\n  Time: " << r.time << "ms | Wins: " << r.wins
-            << "\n  Comparisons: " << r.comparisons << " | Loops: " << r.loops << " | Operations: " << r.operations << "\n\n";
+            << "\n  Comparisons: " << r.comparisons << " | Loops: " << r.loops << " | Operations: " << r.operations << " | Moves: " << r.moves << "\n";
+        if (perf_counters::enabled)
+        {
+            std::cout << "  Cycles: " << r.cycles << " | Instructions: " << r.instructions << " | Branch misses: " << r.branchMisses
+                << "\n  L1 misses: " << r.l1Misses << " | LLC misses: " << r.llcMisses << " | TLB misses: " << r.tlbMisses << "\n";
+        }
+        std::cout << "\n";
     }
 }
 
+// Positive count argument of a mode (at most maxValue), anything else is reported
+bool GetCountArgument(const char* argument, const std::string& name, unsigned long& value, unsigned long maxValue = ULONG_MAX)
+{
+    if (utilis::ParseCount(argument, value) && value <= maxValue) return true;
+    std::cerr << "ERROR: Invalid " << name << " (expected a positive number up to " << maxValue << "): " << argument << std::endl;
+    return false;
+}
+
 
-int main() 
+int main(int argc, char* argv[]) 
 {
+    // Fitness selection: --fitness "0.7*time+0.3*moves" (default operations), --pareto time,comparisons,moves (GAv5 NSGA-II mode)
+    // Time measurement of the searches: --timing auto|parallel|isolated (auto - isolated when time is in the fitness
+    // or among the --pareto objectives, with parallel timing a time objective ranks contended multi-threaded times)
+    // Input data (workers need the same): --inputs "uniform:0.4,nearlySorted(0.01):0.2,reversed:0.1,fewUnique(16):0.1,organPipe:0.1,sortedRuns(32):0.1"
+    for (int a = 1; a + 1 < argc; a++)
+    {
+        std::string option = argv[a];
+        if (option == "--fitness" && !fitnessFunction.Parse(argv[a + 1])) return 1;
+        if (option == "--inputs" && !distributions::ParseMixture(argv[a + 1], utilis::inputMixture)) return 1;
+        if (option == "--timing" && !timing::ParseSearchTiming(argv[a + 1], timing::searchTiming))
+        {
+            std::cerr << "ERROR: Unknown timing mode (expected auto, parallel or isolated): " << argv[a + 1] << std::endl;
+            return 1;
+        }
+        if (option == "--pareto")
+        {
+            for (const std::string& name : utilis::SplitString(argv[a + 1], ","))
+            {
+                FitnessObjective objective;
+                if (!ParseObjective(name, objective)) { std::cerr << "ERROR: Unknown fitness objective: " << name << std::endl; return 1; }
+                search_genetic_v5::paretoObjectives.push_back(objective);
+            }
+        }
+    }
+
+    // Worker mode: ./ShellsortResearch worker unix:/tmp/shellsort.sock (or tcp:host:port)
+    if (argc >= 3 && std::string(argv[1]) == "worker")
+    {
+        distributed::RunWorker(argv[2]);
+        return 0;
+    }
+
+    // Store conversion: ./ShellsortResearch store-import Results/Candidates.store Results Results/Backups
+    //                   ./ShellsortResearch store-export Results/Candidates.store Results/Exported
+    if (argc >= 4 && std::string(argv[1]) == "store-import")
+    {
+        return candidate_store::ConvertTextToStore(std::vector<std::string>(argv + 3, argv + argc), argv[2]) ? 0 : 1;
+    }
+    if (argc >= 4 && std::string(argv[1]) == "store-export")
+    {
+        return candidate_store::ConvertStoreToText(argv[2], argv[3]) ? 0 : 1;
+    }
+
+    // Vectorized passes of every instruction set the CPU supports checked against scalar ones: ./ShellsortResearch verify-simd
+    if (argc >= 2 && std::string(argv[1]) == "verify-simd")
+    {
+        bool valid = true;
+        for (simd::InstructionSet instructionSet : { simd::InstructionSet::AVX2, simd::InstructionSet::AVX512 })
+        {
+            if (instructionSet > simd::GetSupportedInstructionSet()) continue;
+            bool setValid = true;
+            for (unsigned long sortingRange : { 100UL, 1000UL, 1001UL, 12345UL })
+            {
+                setValid = simd::VerifyPasses(sortingRange, { 132, 57, 23, 17, 13, 10, 8, 1 }, 10, instructionSet) && setValid;
+                setValid = simd::VerifyPasses(sortingRange, GetTokudaGaps(sortingRange).gaps, 10, instructionSet) && setValid;
+            }
+            std::cout << simd::GetInstructionSetName(instructionSet) << (setValid ? " passes match scalar passes" : " passes differ from scalar passes") << std::endl;
+            valid = valid && setValid;
+        }
+        return valid ? 0 : 1;
+    }
+
+    // Scaling sweep of the baselines (and sequences of candidates files) up to maxRange:
+    // ./ShellsortResearch sweep 100000000 Results/CandidateGapSequences1000_GAv5.txt
+    // sweep-extended - the same with sequences of the files continued by their fitted growth ratio
+    if (argc >= 3 && (std::string(argv[1]) == "sweep" || std::string(argv[1]) == "sweep-extended"))
+    {
+        scaling::SweepOptions options;
+        if (!GetCountArgument(argv[2], "maximum range", options.maxRange)) return 1;
+        const bool extended = std::string(argv[1]) == "sweep-extended";
+        std::vector<scaling::SweepSequence> sequences = scaling::GetBaselineSweepSequences();
+        for (int a = 3; a < argc && std::string(argv[a]).rfind("--", 0) != 0; a++)
+        {
+            for (const GapSequence& gs : files::GetGapsFromPath(argv[a]))
+            {
+                sequences.push_back(extended ? scaling::GetExtendedSweepSequence(gs) : scaling::GetFixedSweepSequence(gs));
+            }
+        }
+        scaling::RunScalingSweep(sequences, options);
+        return 0;
+    }
+
+    // Found sequences extended to a target size (up to 2^63) and checked against the baselines there:
+    // ./ShellsortResearch extend 1000000 20 Results/CandidateGapSequences1000_GAv5.txt
+    if (argc >= 5 && std::string(argv[1]) == "extend")
+    {
+        unsigned long targetRange = 0, iterations = 0;
+        if (!GetCountArgument(argv[2], "target range", targetRange) || !GetCountArgument(argv[3], "iterations", iterations, INT_MAX)) return 1;
+        for (int a = 4; a < argc && std::string(argv[a]).rfind("--", 0) != 0; a++)
+        {
+            for (const GapSequence& gs : files::GetGapsFromPath(argv[a]))
+            {
+                std::vector<Result> results = extrapolation::CheckExtendedSequence(gs, targetRange, static_cast<int>(iterations));
+                PrintResults(results, results.size());
+            }
+        }
+        return 0;
+    }
+
+    // Hybrid sort with block size tuned on 10^5 elements, then benchmarked against std::sort up to maxRange:
+    // ./ShellsortResearch hybrid 10000000 10
+    if (argc >= 4 && std::string(argv[1]) == "hybrid")
+    {
+        scaling::SweepOptions options;
+        unsigned long iterations = 0;
+        if (!GetCountArgument(argv[2], "maximum range", options.maxRange) || !GetCountArgument(argv[3], "iterations", iterations, INT_MAX)) return 1;
+        hybrid::TuneBlockSize(100000, { 100, 500, 1000, 2000, 5000 }, static_cast<int>(iterations));
+        std::cout << "Hybrid sort: block size " << hybrid::blockSize << " with gaps";
+        for (unsigned long gap : hybrid::blockGaps) std::cout << " " << gap;
+        std::cout << "\n";
+
+        hybrid::CompareWithStdSort(scaling::GetSortingRanges(options), static_cast<int>(iterations));
+        return 0;
+    }
+
+    std::cout << "Fitness: " << fitnessFunction.ToString() << " (" << (timing::IsSearchTimingIsolated(search_genetic_v5::paretoObjectives) ? "isolated" : "parallel") << " timing)\n";
+
+    // utilis::SetRunSeed(42); // reproduce a previous run
+    // utilis::commonRandomNumbers = true; // same datasets in every generation
+    // checkpoint::resume = true; // continue from Results/Checkpoints (only checkpoints of the same --fitness and --inputs)
+    // perf_counters::enabled = true; SetFitnessObjective(FitnessObjective::Cycles); // real-machine cost as fitness
+    std::cout << "Run seed: " << utilis::GetRunSeed() << "\n";
+
     std::vector<GapSequence> gapSequences = 
     { 
         GetTokudaGaps(SORTING_RANGE),
@@ -39,6 +184,9 @@ int main()
     };
 
 
+    // // seed with every unique sequence found so far for this range, Results and Results/Backups
+    // for (GapSequence& gs : files::GetCandidateGapSequences(SORTING_RANGE)) gapSequences.push_back(gs);
+
     for (int i = gapSequences.size(); i<100; i++) gapSequences.push_back(GapSequence("1|Random|" + std::to_string(i + 1), GetRandomizedGaps(SORTING_RANGE)));
     
     // #pragma omp parallel sections num_threads(5) firstprivate(gapSequences)
@@ -67,6 +215,37 @@ int main()
 
     search_genetic_v5::EndlessGapSeeking(SORTING_RANGE, gapSequences, 100);
 
+    // // evaluation spread over worker processes, which can join and leave at any time
+    // distributed::Coordinator coordinator("tcp:0.0.0.0:5555");
+    // auto distributedResults = CompareShellsorts_Distributed(coordinator, SORTING_RANGE, gapSequences, 1000);
+    // PrintResults(distributedResults, 10);
+
+    // // all algorithms at once, each on its share of the cores, migrating top 3 sequences every 5 generations
+    // search_islands::EndlessIslandSeeking(SORTING_RANGE, gapSequences, 100);
+
+    // // all-cores sort of 16M elements: 256 KiB chunks Shellsorted with the best sequence for 65536, then a loser tree merge
+    // GapSequence chunkGaps = hybrid::GetBestBlockGaps(parallel_shellsort::chunkBytes / sizeof(int), 100);
+    // for (ScalingResult& r : MeasureParallelShellsortScaling(16000000, chunkGaps, omp_get_max_threads(), 5, true))
+    // {
+    //     std::cout << r.threads << " threads: " << r.time << "ms | speedup " << r.speedup << "\n";
+    // }
+
+    // // time as the target: pinned thread, warm-up, interleaved repetitions, median with MAD and confidence interval
+    // SetFitnessObjective(FitnessObjective::Time);
+    // for (Result& r : CompareShellsorts_Timed(SORTING_RANGE, gapSequences, 200))
+    // {
+    //     r.gapSequence.PrintInstance();
+    //     std::cout << "\n  Median: " << r.time << "ms | MAD: " << r.timeMad << "ms | CI: +-" << r.timeConfidenceInterval << "ms\n";
+    // }
+
+    // // 128-byte records: shifted whole, sorted through cached (key, index) pairs, through pointers, or as key+payload columns
+    // SetFitnessObjective(FitnessObjective::Time);
+    // for (RecordSortMode mode : { RecordSortMode::Direct, RecordSortMode::Indirect, RecordSortMode::Pointer, RecordSortMode::KeyPayload })
+    // {
+    //     auto recordResults = CompareShellsorts_Records<124>(SORTING_RANGE, gapSequences, 100, mode);
+    //     PrintResults(recordResults, 3);
+    // }
+
     // for (GapSequence& gs : files::GetGapsFromFile("CandidateGapSequences" + std::to_string(SORTING_RANGE) + "_GAv5.txt")) gapSequences.push_back(gs);
     // auto results = CompareShellsorts(SORTING_RANGE, gapSequences, 1000);
     // PrintResults(results, 10);
@@ -89,6 +268,14 @@ int main()
     //     });
     // PrintResults(finalResults, finalGroup.size()); 
 
+    // files::SaveFixedGapsKernelsToFile("CandidateGapSequences" + std::to_string(SORTING_RANGE) + "_GAv5.txt");
+    // // after recompiling with #include "Results/Kernels/CandidateGapSequences1000_GAv5_Kernels.hpp":
+    // for (FixedKernelResult& r : CompareFixedShellsorts(SORTING_RANGE, kernels_CANDIDATEGAPSEQUENCES1000_GAV5::kernels, 1000))
+    // {
+    //     r.gapSequence.PrintInstance();
+    //     std::cout << "\n  Runtime: " << r.runtimeTime << "ms | Fixed: " << r.fixedTime << "ms | Speedup: " << r.GetSpeedup() << "\n";
+    // }
+
     // unsigned long sortingRange = 1000;
     // std::vector<GapSequence> finalGroup = 
     // { 